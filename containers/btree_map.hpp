@@ -0,0 +1,981 @@
+#ifndef BTREE_MAP_HPP
+# define BTREE_MAP_HPP
+
+#include <new>
+#include "../iterators/utils.hpp"
+#include "../iterators/pair.hpp"
+#include "../iterators/btree_node.hpp"
+#include "../iterators/btree_iterator.hpp"
+#include "../iterators/reverse_iterator.hpp"
+
+namespace ft
+{
+	//B+tree with the interface of ft::map. Nodes are NodeBytes long, a few
+	//cache lines, and hold many keys each, so a lookup touches one node per
+	//level instead of one per key. Values only live in the leaves, which are
+	//linked for the scans.
+	//Unlike ft::map, insert and erase invalidate every iterator: values move
+	//between slots when nodes split, borrow or merge.
+	template <class Key, class T, class Compare = std::less<Key>, class Alloc = std::allocator<ft::pair<const Key,T> >, size_t NodeBytes = 256>
+	class btree_map
+	{
+		public:
+			typedef Key 														key_type;
+			typedef T 															mapped_type;
+			typedef ft::pair<const key_type,mapped_type> 						value_type;
+			typedef Compare 													key_compare;
+			typedef Alloc 														allocator_type;
+			typedef typename allocator_type::reference 							reference;
+			typedef typename allocator_type::const_reference 					const_reference;
+			typedef typename allocator_type::pointer 							pointer;
+			typedef typename allocator_type::const_pointer 						const_pointer;
+			typedef std::ptrdiff_t 												difference_type;
+			typedef size_t 														size_type;
+
+			//What fits in NodeBytes once the header is paid, at least 4
+			static const size_t	leaf_capacity = (NodeBytes - sizeof(btree_node) - 2 * sizeof(void *)) / sizeof(value_type) < 4 ? 4 : (NodeBytes - sizeof(btree_node) - 2 * sizeof(void *)) / sizeof(value_type);
+			static const size_t	inner_capacity = (NodeBytes - sizeof(btree_node) - sizeof(void *)) / (sizeof(key_type) + sizeof(void *)) < 4 ? 4 : (NodeBytes - sizeof(btree_node) - sizeof(void *)) / (sizeof(key_type) + sizeof(void *));
+
+			typedef btree_leaf<value_type, leaf_capacity>						leaf_node;
+			typedef btree_inner<key_type, inner_capacity>						inner_node;
+			typedef ft::btree_iterator<leaf_node, value_type>					iterator;
+			typedef ft::const_btree_iterator<leaf_node, const value_type, iterator>	const_iterator;
+			typedef ft::reverse_iterator<iterator> 								reverse_iterator;
+			typedef ft::reverse_iterator<const_iterator>						const_reverse_iterator;
+			typedef typename Alloc::template rebind<leaf_node>::other			leaf_allocator_type;
+			typedef typename Alloc::template rebind<inner_node>::other			inner_allocator_type;
+
+		private:
+			//Deep enough for any tree: inner nodes keep at least 3 children
+			static const size_t	max_depth = 64;
+
+			key_compare				_compare;
+			allocator_type			_alloc;
+			leaf_allocator_type		_leaf_alloc;
+			inner_allocator_type	_inner_alloc;
+			btree_node				*_root;
+			leaf_node				*_first;
+			leaf_node				*_last;
+			size_type				_size;
+
+		public:
+
+			class value_compare
+			{
+				friend class btree_map;
+
+				protected:
+
+					Compare comp;
+
+					value_compare(Compare c): comp(c)
+					{
+
+					}
+
+				public:
+
+					typedef bool result_type;
+					typedef value_type first_argument_type;
+					typedef value_type second_argument_type;
+
+					bool operator()(const value_type &x, const value_type &y) const
+					{
+						return (comp(x.first, y.first));
+					}
+			};
+
+		btree_map(const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type()): _compare(comp), _alloc(alloc), _leaf_alloc(alloc), _inner_alloc(alloc), _root(NULL), _first(NULL), _last(NULL), _size(0)
+		{
+
+		}
+
+		template <class InputIterator>
+		btree_map(InputIterator first, InputIterator last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type()): _compare(comp), _alloc(alloc), _leaf_alloc(alloc), _inner_alloc(alloc), _root(NULL), _first(NULL), _last(NULL), _size(0)
+		{
+			insert(first, last);
+		}
+
+		btree_map(const btree_map &x): _compare(x._compare), _alloc(x._alloc), _leaf_alloc(x._leaf_alloc), _inner_alloc(x._inner_alloc), _root(NULL), _first(NULL), _last(NULL), _size(0)
+		{
+			copyFrom(x);
+		}
+
+		~btree_map()
+		{
+			clear();
+		}
+
+		btree_map& operator=(const btree_map& x)
+		{
+			if (this == &x)
+				return (*this);
+			clear();
+			_compare = x._compare;
+			copyFrom(x);
+			return (*this);
+		}
+
+		//Iterators
+
+		iterator begin()
+		{
+			return (iterator(_first, 0));
+		}
+
+		const_iterator begin() const
+		{
+			return (const_iterator(_first, 0));
+		}
+
+		iterator end()
+		{
+			return (iterator(_last, _last ? _last->count : 0));
+		}
+
+		const_iterator end() const
+		{
+			return (const_iterator(_last, _last ? _last->count : 0));
+		}
+
+		reverse_iterator rbegin()
+		{
+			return (reverse_iterator(end()));
+		}
+
+		const_reverse_iterator rbegin() const
+		{
+			return (const_reverse_iterator(end()));
+		}
+
+		reverse_iterator rend()
+		{
+			return (reverse_iterator(begin()));
+		}
+
+		const_reverse_iterator rend() const
+		{
+			return (const_reverse_iterator(begin()));
+		}
+
+		//Capacity
+
+		bool empty() const
+		{
+			return (_size == 0);
+		}
+
+		size_type size() const
+		{
+			return (_size);
+		}
+
+		size_type max_size() const
+		{
+			return (std::numeric_limits<size_type>::max() / sizeof(value_type));
+		}
+
+		//Observers
+
+		key_compare key_comp() const
+		{
+			return (_compare);
+		}
+
+		value_compare value_comp() const
+		{
+			return (value_compare(_compare));
+		}
+
+		//Element access
+
+		mapped_type& operator[](const key_type& k)
+		{
+			inner_node	*path[max_depth];
+			size_t		slots[max_depth];
+			size_t		depth;
+
+			if (!_root)
+				_root = _first = _last = createLeaf();
+			leaf_node *leaf = descend(k, path, slots, depth);
+			size_t pos = leafLower(leaf, k);
+			if (pos < leaf->count && !_compare(k, leaf->values()[pos].first))
+				return (leaf->values()[pos].second);
+			return (insertAt(leaf, pos, value_type(k, mapped_type()), path, slots, depth)->second);
+		}
+
+		//Modifiers
+
+		ft::pair<iterator,bool> insert(const value_type& val)
+		{
+			inner_node	*path[max_depth];
+			size_t		slots[max_depth];
+			size_t		depth;
+
+			if (!_root)
+				_root = _first = _last = createLeaf();
+			leaf_node *leaf = descend(val.first, path, slots, depth);
+			size_t pos = leafLower(leaf, val.first);
+			if (pos < leaf->count && !_compare(val.first, leaf->values()[pos].first))
+				return (ft::make_pair(iterator(leaf, pos), false));
+			return (ft::make_pair(insertAt(leaf, pos, val, path, slots, depth), true));
+		}
+
+		//The hint does not save anything here: a split needs the path from
+		//the root, which only a descent gives
+		iterator insert(iterator position, const value_type& val)
+		{
+			(void)position;
+			return (insert(val).first);
+		}
+
+		template <class InputIterator>
+		void insert(InputIterator first, InputIterator last)
+		{
+			for (; first != last; ++first)
+				insert(*first);
+		}
+
+		void erase(iterator position)
+		{
+			erase(position->first);
+		}
+
+		size_type erase(const key_type& k)
+		{
+			inner_node	*path[max_depth];
+			size_t		slots[max_depth];
+			size_t		depth;
+
+			if (!_root)
+				return (0);
+			leaf_node *leaf = descend(k, path, slots, depth);
+			size_t pos = leafLower(leaf, k);
+			if (pos == leaf->count || _compare(k, leaf->values()[pos].first))
+				return (0);
+			eraseAt(leaf, pos, path, slots, depth);
+			return (1);
+		}
+
+		//Every erase may move the values around, so the next one is found
+		//again from the key that followed the erased one
+		void erase(iterator first, iterator last)
+		{
+			if (first == begin() && last == end())
+			{
+				clear();
+				return ;
+			}
+			size_type n = 0;
+			for (iterator it = first; it != last; ++it)
+				n++;
+			while (n--)
+			{
+				key_type k(first->first);
+				erase(k);
+				if (n)
+					first = lower_bound(k);
+			}
+		}
+
+		void swap(btree_map &x)
+		{
+			if (&x == this)
+				return ;
+			std::swap(_root, x._root);
+			std::swap(_first, x._first);
+			std::swap(_last, x._last);
+			std::swap(_size, x._size);
+			std::swap(_compare, x._compare);
+			std::swap(_alloc, x._alloc);
+			std::swap(_leaf_alloc, x._leaf_alloc);
+			std::swap(_inner_alloc, x._inner_alloc);
+		}
+
+		void clear()
+		{
+			if (_root)
+				destroyNode(_root);
+			_root = NULL;
+			_first = NULL;
+			_last = NULL;
+			_size = 0;
+		}
+
+		//Operations
+
+		iterator find(const key_type& k)
+		{
+			leaf_node	*leaf;
+			size_t		pos;
+
+			if (!lookup(k, leaf, pos))
+				return (end());
+			return (iterator(leaf, pos));
+		}
+
+		const_iterator find(const key_type& k) const
+		{
+			leaf_node	*leaf;
+			size_t		pos;
+
+			if (!lookup(k, leaf, pos))
+				return (end());
+			return (const_iterator(leaf, pos));
+		}
+
+		size_type count(const key_type& k) const
+		{
+			leaf_node	*leaf;
+			size_t		pos;
+
+			return (lookup(k, leaf, pos) ? 1 : 0);
+		}
+
+		iterator lower_bound(const key_type& k)
+		{
+			size_t pos;
+			leaf_node *leaf = _lower_bound(k, pos);
+			return (iterator(leaf, pos));
+		}
+
+		const_iterator lower_bound(const key_type& k) const
+		{
+			size_t pos;
+			leaf_node *leaf = _lower_bound(k, pos);
+			return (const_iterator(leaf, pos));
+		}
+
+		iterator upper_bound(const key_type& k)
+		{
+			size_t pos;
+			leaf_node *leaf = _upper_bound(k, pos);
+			return (iterator(leaf, pos));
+		}
+
+		const_iterator upper_bound(const key_type& k) const
+		{
+			size_t pos;
+			leaf_node *leaf = _upper_bound(k, pos);
+			return (const_iterator(leaf, pos));
+		}
+
+		ft::pair<iterator,iterator> equal_range(const key_type& k)
+		{
+			iterator first = lower_bound(k);
+
+			if (first != end() && !_compare(k, first->first))
+			{
+				iterator last = first;
+				return (ft::make_pair(first, ++last));
+			}
+			return (ft::make_pair(first, first));
+		}
+
+		ft::pair<const_iterator,const_iterator> equal_range(const key_type& k) const
+		{
+			const_iterator first = lower_bound(k);
+
+			if (first != end() && !_compare(k, first->first))
+			{
+				const_iterator last = first;
+				return (ft::make_pair(first, ++last));
+			}
+			return (ft::make_pair(first, first));
+		}
+
+		//Allocator
+
+		allocator_type get_allocator(void) const
+		{
+			allocator_type allocator_copy(_alloc);
+			return (allocator_copy);
+		}
+
+		private :
+
+		leaf_node *createLeaf(void)
+		{
+			leaf_node *leaf = _leaf_alloc.allocate(1);
+
+			leaf->count = 0;
+			leaf->leaf = true;
+			leaf->prev = NULL;
+			leaf->next = NULL;
+			return (leaf);
+		}
+
+		inner_node *createInner(void)
+		{
+			inner_node *inner = _inner_alloc.allocate(1);
+
+			inner->count = 0;
+			inner->leaf = false;
+			return (inner);
+		}
+
+		void destroyLeaf(leaf_node *leaf)
+		{
+			for (size_t i = 0; i < leaf->count; i++)
+				_alloc.destroy(leaf->values() + i);
+			_leaf_alloc.deallocate(leaf, 1);
+		}
+
+		void destroyInner(inner_node *inner)
+		{
+			for (size_t i = 0; i < inner->count; i++)
+				destroyKey(inner->keys() + i);
+			_inner_alloc.deallocate(inner, 1);
+		}
+
+		void destroyNode(btree_node *node)
+		{
+			if (node->leaf)
+				return (destroyLeaf(static_cast<leaf_node *>(node)));
+			inner_node *inner = static_cast<inner_node *>(node);
+			for (size_t i = 0; i <= inner->count; i++)
+				destroyNode(inner->children[i]);
+			destroyInner(inner);
+		}
+
+		void constructKey(key_type *p, const key_type &k)
+		{
+			new (p) key_type(k);
+		}
+
+		void destroyKey(key_type *p)
+		{
+			p->~key_type();
+		}
+
+		void replaceKey(key_type *p, const key_type &k)
+		{
+			destroyKey(p);
+			constructKey(p, k);
+		}
+
+		//Moves the value at src to the empty slot dst
+		void moveValue(value_type *dst, value_type *src)
+		{
+			_alloc.construct(dst, *src);
+			_alloc.destroy(src);
+		}
+
+		void moveKey(key_type *dst, key_type *src)
+		{
+			constructKey(dst, *src);
+			destroyKey(src);
+		}
+
+		//Copies the tree of x node by node, the leaves are chained in the
+		//order they are built which is the key order
+		void copyFrom(const btree_map &x)
+		{
+			leaf_node *prev = NULL;
+
+			if (!x._root)
+				return ;
+			_root = cloneNode(x._root, prev);
+			_last = prev;
+			_size = x._size;
+		}
+
+		btree_node *cloneNode(const btree_node *src, leaf_node *&prev)
+		{
+			if (src->leaf)
+			{
+				const leaf_node *from = static_cast<const leaf_node *>(src);
+				leaf_node *leaf = createLeaf();
+
+				for (; leaf->count < from->count; leaf->count++)
+					_alloc.construct(leaf->values() + leaf->count, from->values()[leaf->count]);
+				leaf->prev = prev;
+				if (prev)
+					prev->next = leaf;
+				else
+					_first = leaf;
+				prev = leaf;
+				return (leaf);
+			}
+			const inner_node *from = static_cast<const inner_node *>(src);
+			inner_node *inner = createInner();
+			inner->children[0] = cloneNode(from->children[0], prev);
+			for (; inner->count < from->count; inner->count++)
+			{
+				inner->children[inner->count + 1] = cloneNode(from->children[inner->count + 1], prev);
+				constructKey(inner->keys() + inner->count, from->keys()[inner->count]);
+			}
+			return (inner);
+		}
+
+		//First key of the inner node greater than k, which is also the child
+		//that may hold k
+		size_t innerSlot(const inner_node *inner, const key_type &k) const
+		{
+			size_t low = 0;
+			size_t high = inner->count;
+
+			while (low < high)
+			{
+				size_t mid = (low + high) / 2;
+				if (_compare(k, inner->keys()[mid]))
+					high = mid;
+				else
+					low = mid + 1;
+			}
+			return (low);
+		}
+
+		//First value of the leaf not less than k
+		size_t leafLower(const leaf_node *leaf, const key_type &k) const
+		{
+			size_t low = 0;
+			size_t high = leaf->count;
+
+			while (low < high)
+			{
+				size_t mid = (low + high) / 2;
+				if (_compare(leaf->values()[mid].first, k))
+					low = mid + 1;
+				else
+					high = mid;
+			}
+			return (low);
+		}
+
+		//First value of the leaf greater than k
+		size_t leafUpper(const leaf_node *leaf, const key_type &k) const
+		{
+			size_t low = 0;
+			size_t high = leaf->count;
+
+			while (low < high)
+			{
+				size_t mid = (low + high) / 2;
+				if (_compare(k, leaf->values()[mid].first))
+					high = mid;
+				else
+					low = mid + 1;
+			}
+			return (low);
+		}
+
+		//Goes down to the leaf that holds k or would hold it. path and slots
+		//get the inner nodes crossed and the child taken in each, for the
+		//splits and merges that follow.
+		leaf_node *descend(const key_type &k, inner_node **path, size_t *slots, size_t &depth) const
+		{
+			btree_node *node = _root;
+
+			depth = 0;
+			while (!node->leaf)
+			{
+				inner_node *inner = static_cast<inner_node *>(node);
+				size_t slot = innerSlot(inner, k);
+				path[depth] = inner;
+				slots[depth] = slot;
+				depth++;
+				node = inner->children[slot];
+			}
+			return (static_cast<leaf_node *>(node));
+		}
+
+		leaf_node *descend(const key_type &k) const
+		{
+			btree_node *node = _root;
+
+			while (!node->leaf)
+			{
+				inner_node *inner = static_cast<inner_node *>(node);
+				node = inner->children[innerSlot(inner, k)];
+			}
+			return (static_cast<leaf_node *>(node));
+		}
+
+		bool lookup(const key_type &k, leaf_node *&leaf, size_t &pos) const
+		{
+			if (!_root)
+				return (false);
+			leaf = descend(k);
+			pos = leafLower(leaf, k);
+			return (pos < leaf->count && !_compare(k, leaf->values()[pos].first));
+		}
+
+		//Position of the lower bound of k. The bound is the first value of
+		//the next leaf when k is above all the keys of its own leaf.
+		leaf_node *_lower_bound(const key_type &k, size_t &pos) const
+		{
+			pos = 0;
+			if (!_root)
+				return (NULL);
+			leaf_node *leaf = descend(k);
+			pos = leafLower(leaf, k);
+			if (leaf->next && pos == leaf->count)
+			{
+				pos = 0;
+				return (leaf->next);
+			}
+			return (leaf);
+		}
+
+		leaf_node *_upper_bound(const key_type &k, size_t &pos) const
+		{
+			pos = 0;
+			if (!_root)
+				return (NULL);
+			leaf_node *leaf = descend(k);
+			pos = leafUpper(leaf, k);
+			if (leaf->next && pos == leaf->count)
+			{
+				pos = 0;
+				return (leaf->next);
+			}
+			return (leaf);
+		}
+
+		//Puts val at pos in leaf, splitting it when full. When the leaf is
+		//the last one and val goes at its end, the leaf is left full and val
+		//starts a new one, so that ascending insertions fill every node.
+		iterator insertAt(leaf_node *leaf, size_t pos, const value_type &val, inner_node **path, size_t *slots, size_t depth)
+		{
+			_size++;
+			if (leaf->count < leaf_capacity)
+			{
+				insertValue(leaf, pos, val);
+				return (iterator(leaf, pos));
+			}
+			bool append = (pos == leaf->count && !leaf->next);
+			size_t split = append ? leaf_capacity : (leaf_capacity + 1) / 2;
+			leaf_node *right = createLeaf();
+
+			for (size_t i = split; i < leaf->count; i++)
+				moveValue(right->values() + i - split, leaf->values() + i);
+			right->count = leaf->count - split;
+			leaf->count = split;
+			right->prev = leaf;
+			right->next = leaf->next;
+			if (leaf->next)
+				leaf->next->prev = right;
+			else
+				_last = right;
+			leaf->next = right;
+			iterator ret;
+			if (pos < split)
+			{
+				insertValue(leaf, pos, val);
+				ret = iterator(leaf, pos);
+			}
+			else
+			{
+				insertValue(right, pos - split, val);
+				ret = iterator(right, pos - split);
+			}
+			insertChild(path, slots, depth, right->values()[0].first, right, append);
+			return (ret);
+		}
+
+		void insertValue(leaf_node *leaf, size_t pos, const value_type &val)
+		{
+			for (size_t i = leaf->count; i > pos; i--)
+				moveValue(leaf->values() + i, leaf->values() + i - 1);
+			_alloc.construct(leaf->values() + pos, val);
+			leaf->count++;
+		}
+
+		//Key j of the inner node once k is inserted at slot
+		const key_type &keyAfterInsert(inner_node *inner, size_t slot, const key_type &k, size_t j) const
+		{
+			if (j < slot)
+				return (inner->keys()[j]);
+			if (j == slot)
+				return (k);
+			return (inner->keys()[j - 1]);
+		}
+
+		//Child j of the inner node once child is inserted after slot
+		btree_node *childAfterInsert(inner_node *inner, size_t slot, btree_node *child, size_t j) const
+		{
+			if (j <= slot)
+				return (inner->children[j]);
+			if (j == slot + 1)
+				return (child);
+			return (inner->children[j - 1]);
+		}
+
+		//Hands the separator k and the new node child, right of the child
+		//that was split, to the parent at the end of path
+		void insertChild(inner_node **path, size_t *slots, size_t depth, const key_type &k, btree_node *child, bool append)
+		{
+			if (depth == 0)
+			{
+				inner_node *root = createInner();
+				root->children[0] = _root;
+				root->children[1] = child;
+				constructKey(root->keys(), k);
+				root->count = 1;
+				_root = root;
+				return ;
+			}
+			inner_node *inner = path[depth - 1];
+			size_t slot = slots[depth - 1];
+			if (inner->count < inner_capacity)
+			{
+				for (size_t i = inner->count; i > slot; i--)
+				{
+					moveKey(inner->keys() + i, inner->keys() + i - 1);
+					inner->children[i + 1] = inner->children[i];
+				}
+				constructKey(inner->keys() + slot, k);
+				inner->children[slot + 1] = child;
+				inner->count++;
+				return ;
+			}
+			//Split around key mid of the inner_capacity + 1 keys: the left
+			//half stays, mid goes up and the right half moves to a new node.
+			//When appending the new node only gets the last key, it needs
+			//one so that it has a sibling to borrow from or merge with.
+			size_t mid = append ? inner_capacity - 1 : (inner_capacity + 1) / 2;
+			inner_node *right = createInner();
+
+			for (size_t j = mid + 1; j <= inner_capacity; j++)
+				constructKey(right->keys() + j - mid - 1, keyAfterInsert(inner, slot, k, j));
+			for (size_t j = mid + 1; j <= inner_capacity + 1; j++)
+				right->children[j - mid - 1] = childAfterInsert(inner, slot, child, j);
+			right->count = inner_capacity - mid;
+			key_type up(keyAfterInsert(inner, slot, k, mid));
+			if (slot < mid)
+			{
+				for (size_t i = mid - 1; i < inner_capacity; i++)
+					destroyKey(inner->keys() + i);
+				for (size_t i = mid - 1; i > slot; i--)
+					moveKey(inner->keys() + i, inner->keys() + i - 1);
+				constructKey(inner->keys() + slot, k);
+				for (size_t i = mid; i > slot + 1; i--)
+					inner->children[i] = inner->children[i - 1];
+				inner->children[slot + 1] = child;
+			}
+			else
+			{
+				for (size_t i = mid; i < inner_capacity; i++)
+					destroyKey(inner->keys() + i);
+			}
+			inner->count = mid;
+			insertChild(path, slots, depth - 1, up, right, append);
+		}
+
+		void eraseAt(leaf_node *leaf, size_t pos, inner_node **path, size_t *slots, size_t depth)
+		{
+			_alloc.destroy(leaf->values() + pos);
+			for (size_t i = pos + 1; i < leaf->count; i++)
+				moveValue(leaf->values() + i - 1, leaf->values() + i);
+			leaf->count--;
+			_size--;
+			fixLeaf(leaf, path, slots, depth);
+		}
+
+		//Refills a leaf left under half full from a sibling, or merges it
+		//with one when they both are that low
+		void fixLeaf(leaf_node *leaf, inner_node **path, size_t *slots, size_t depth)
+		{
+			if (depth == 0)
+			{
+				if (leaf->count == 0)
+				{
+					destroyLeaf(leaf);
+					_root = NULL;
+					_first = NULL;
+					_last = NULL;
+				}
+				return ;
+			}
+			if (leaf->count >= leaf_capacity / 2)
+				return ;
+			inner_node *parent = path[depth - 1];
+			size_t slot = slots[depth - 1];
+			leaf_node *left = slot > 0 ? static_cast<leaf_node *>(parent->children[slot - 1]) : NULL;
+			leaf_node *right = slot < parent->count ? static_cast<leaf_node *>(parent->children[slot + 1]) : NULL;
+			if (left && left->count > leaf_capacity / 2)
+			{
+				for (size_t i = leaf->count; i > 0; i--)
+					moveValue(leaf->values() + i, leaf->values() + i - 1);
+				moveValue(leaf->values(), left->values() + left->count - 1);
+				left->count--;
+				leaf->count++;
+				replaceKey(parent->keys() + slot - 1, leaf->values()[0].first);
+			}
+			else if (right && right->count > leaf_capacity / 2)
+			{
+				moveValue(leaf->values() + leaf->count, right->values());
+				for (size_t i = 1; i < right->count; i++)
+					moveValue(right->values() + i - 1, right->values() + i);
+				right->count--;
+				leaf->count++;
+				replaceKey(parent->keys() + slot, right->values()[0].first);
+			}
+			else
+			{
+				if (left)
+					mergeLeaves(left, leaf, parent, slot - 1);
+				else
+					mergeLeaves(leaf, right, parent, slot);
+				fixInner(path, slots, depth - 1);
+			}
+		}
+
+		//Moves every value of right at the end of left, then drops right and
+		//the key between them from the parent
+		void mergeLeaves(leaf_node *left, leaf_node *right, inner_node *parent, size_t key)
+		{
+			for (size_t i = 0; i < right->count; i++)
+				moveValue(left->values() + left->count + i, right->values() + i);
+			left->count += right->count;
+			right->count = 0;
+			left->next = right->next;
+			if (right->next)
+				right->next->prev = left;
+			else
+				_last = left;
+			destroyLeaf(right);
+			removeKey(parent, key);
+		}
+
+		//Drops key and the child right of it
+		void removeKey(inner_node *inner, size_t key)
+		{
+			destroyKey(inner->keys() + key);
+			for (size_t i = key + 1; i < inner->count; i++)
+			{
+				moveKey(inner->keys() + i - 1, inner->keys() + i);
+				inner->children[i] = inner->children[i + 1];
+			}
+			inner->count--;
+		}
+
+		//Same as fixLeaf one level up. The key between the two siblings
+		//rotates through the parent instead of being copied.
+		void fixInner(inner_node **path, size_t *slots, size_t level)
+		{
+			inner_node *inner = path[level];
+
+			if (level == 0)
+			{
+				if (inner->count == 0)
+				{
+					_root = inner->children[0];
+					destroyInner(inner);
+				}
+				return ;
+			}
+			if (inner->count >= inner_capacity / 2)
+				return ;
+			inner_node *parent = path[level - 1];
+			size_t slot = slots[level - 1];
+			inner_node *left = slot > 0 ? static_cast<inner_node *>(parent->children[slot - 1]) : NULL;
+			inner_node *right = slot < parent->count ? static_cast<inner_node *>(parent->children[slot + 1]) : NULL;
+			if (left && left->count > inner_capacity / 2)
+			{
+				inner->children[inner->count + 1] = inner->children[inner->count];
+				for (size_t i = inner->count; i > 0; i--)
+				{
+					moveKey(inner->keys() + i, inner->keys() + i - 1);
+					inner->children[i] = inner->children[i - 1];
+				}
+				moveKey(inner->keys(), parent->keys() + slot - 1);
+				inner->children[0] = left->children[left->count];
+				moveKey(parent->keys() + slot - 1, left->keys() + left->count - 1);
+				left->count--;
+				inner->count++;
+			}
+			else if (right && right->count > inner_capacity / 2)
+			{
+				moveKey(inner->keys() + inner->count, parent->keys() + slot);
+				inner->children[inner->count + 1] = right->children[0];
+				moveKey(parent->keys() + slot, right->keys());
+				for (size_t i = 1; i < right->count; i++)
+				{
+					moveKey(right->keys() + i - 1, right->keys() + i);
+					right->children[i - 1] = right->children[i];
+				}
+				right->children[right->count - 1] = right->children[right->count];
+				right->count--;
+				inner->count++;
+			}
+			else
+			{
+				if (left)
+					mergeInners(left, inner, parent, slot - 1);
+				else
+					mergeInners(inner, right, parent, slot);
+				fixInner(path, slots, level - 1);
+			}
+		}
+
+		void mergeInners(inner_node *left, inner_node *right, inner_node *parent, size_t key)
+		{
+			constructKey(left->keys() + left->count, parent->keys()[key]);
+			for (size_t i = 0; i < right->count; i++)
+				moveKey(left->keys() + left->count + 1 + i, right->keys() + i);
+			for (size_t i = 0; i <= right->count; i++)
+				left->children[left->count + 1 + i] = right->children[i];
+			left->count += right->count + 1;
+			right->count = 0;
+			destroyInner(right);
+			removeKey(parent, key);
+		}
+	};
+
+	template<class Key, class T, class Compare, class Alloc, size_t NodeBytes>
+	bool operator==(const ft::btree_map<Key,T,Compare,Alloc,NodeBytes> &lhs, const ft::btree_map<Key,T,Compare,Alloc,NodeBytes> &rhs)
+	{
+		typename ft::btree_map<Key,T,Compare,Alloc,NodeBytes>::const_iterator rit = rhs.begin();
+		typename ft::btree_map<Key,T,Compare,Alloc,NodeBytes>::const_iterator lit = lhs.begin();
+		if (lhs.size() != rhs.size())
+			return false;
+		while (rit != rhs.end() && lit != lhs.end())
+		{
+			if (*rit != *lit)
+				return false;
+			rit++;
+			lit++;
+		}
+		return true;
+	}
+
+	template<class Key, class T, class Compare, class Alloc, size_t NodeBytes>
+	bool operator!=(const ft::btree_map<Key,T,Compare,Alloc,NodeBytes> &lhs, const ft::btree_map<Key,T,Compare,Alloc,NodeBytes> &rhs)
+	{
+		return !(rhs == lhs);
+	}
+
+	template<class Key, class T, class Compare, class Alloc, size_t NodeBytes>
+	bool operator< (const ft::btree_map<Key,T,Compare,Alloc,NodeBytes> &lhs, const ft::btree_map<Key,T,Compare,Alloc,NodeBytes> &rhs)
+	{
+		return (ft::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end()));
+	}
+
+	template<class Key, class T, class Compare, class Alloc, size_t NodeBytes>
+	bool operator<=(const ft::btree_map<Key,T,Compare,Alloc,NodeBytes> &lhs, const ft::btree_map<Key,T,Compare,Alloc,NodeBytes> &rhs)
+	{
+		return !(lhs > rhs);
+	}
+
+	template<class Key, class T, class Compare, class Alloc, size_t NodeBytes>
+	bool operator> (const ft::btree_map<Key,T,Compare,Alloc,NodeBytes> &lhs, const ft::btree_map<Key,T,Compare,Alloc,NodeBytes> &rhs)
+	{
+		return rhs < lhs;
+	}
+
+	template<class Key, class T, class Compare, class Alloc, size_t NodeBytes>
+	bool operator>=(const ft::btree_map<Key,T,Compare,Alloc,NodeBytes> &lhs, const ft::btree_map<Key,T,Compare,Alloc,NodeBytes> &rhs)
+	{
+		return !(lhs < rhs);
+	}
+
+	template<class Key, class T, class Compare, class Alloc, size_t NodeBytes>
+	void swap(ft::btree_map<Key,T,Compare,Alloc,NodeBytes> &lhs, ft::btree_map<Key,T,Compare,Alloc,NodeBytes> &rhs)
+	{
+		return lhs.swap(rhs);
+	}
+}
+
+#endif
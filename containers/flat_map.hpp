@@ -0,0 +1,714 @@
+#ifndef FLAT_MAP_HPP
+# define FLAT_MAP_HPP
+
+#include <algorithm>
+#include "vector.hpp"
+#include "../iterators/utils.hpp"
+#include "../iterators/pair.hpp"
+#include "../iterators/flat_iterator.hpp"
+#include "../iterators/reverse_iterator.hpp"
+
+namespace ft
+{
+	//Pairs side by side in one vector. A lookup strides over the values,
+	//a hit finds its value in the same cache line as its key.
+	template <class Key, class T, class Alloc, bool Split>
+	struct flat_storage
+	{
+		typedef ft::pair<Key, T>				value_type;
+		typedef value_type&						reference;
+		typedef const value_type&				const_reference;
+		typedef value_type*						pointer;
+		typedef const value_type*				const_pointer;
+
+		ft::vector<value_type, Alloc>	values;
+
+		flat_storage(const Alloc &alloc): values(alloc)
+		{
+
+		}
+
+		flat_storage(const flat_storage &x): values(x.values)
+		{
+
+		}
+
+		size_t size() const
+		{
+			return (values.size());
+		}
+
+		const Key &key(size_t i) const
+		{
+			return (values[i].first);
+		}
+
+		T &mapped(size_t i)
+		{
+			return (values[i].second);
+		}
+
+		reference ref(size_t i)
+		{
+			return (values[i]);
+		}
+
+		const_reference ref(size_t i) const
+		{
+			return (values[i]);
+		}
+
+		pointer ptr(size_t i)
+		{
+			return (&values[i]);
+		}
+
+		const_pointer ptr(size_t i) const
+		{
+			return (&values[i]);
+		}
+
+		void push_back(const Key &k, const T &v)
+		{
+			values.push_back(value_type(k, v));
+		}
+
+		//Opens slot i by pushing the last value one further and shifting
+		//the others, then fills it
+		void insert(size_t i, const Key &k, const T &v)
+		{
+			size_t n = values.size();
+			value_type val(k, v);
+
+			if (i < n)
+			{
+				value_type last(values[n - 1]);
+				values.push_back(last);
+				for (size_t j = n - 1; j > i; j--)
+					values[j] = values[j - 1];
+				values[i] = val;
+			}
+			else
+				values.push_back(val);
+		}
+
+		void erase(size_t first, size_t last)
+		{
+			values.erase(values.begin() + first, values.begin() + last);
+		}
+
+		void reserve(size_t n)
+		{
+			values.reserve(n);
+		}
+
+		size_t capacity() const
+		{
+			return (values.capacity());
+		}
+
+		void clear()
+		{
+			values.clear();
+		}
+
+		void swap(flat_storage &x)
+		{
+			values.swap(x.values);
+		}
+	};
+
+	//Keys and values in two vectors. A lookup only reads keys, so more of
+	//them fit in each cache line, and values are only touched on a hit.
+	//Dereferencing gives a pair of references, built on the fly.
+	template <class Key, class T, class Alloc>
+	struct flat_storage<Key, T, Alloc, true>
+	{
+		typedef typename Alloc::template rebind<Key>::other	key_allocator_type;
+		typedef typename Alloc::template rebind<T>::other	mapped_allocator_type;
+		typedef ft::pair<Key, T>							value_type;
+		typedef ft::pair<const Key&, T&>					reference;
+		typedef ft::pair<const Key&, const T&>				const_reference;
+		typedef ft::flat_arrow<reference>					pointer;
+		typedef ft::flat_arrow<const_reference>				const_pointer;
+
+		ft::vector<Key, key_allocator_type>		keys;
+		ft::vector<T, mapped_allocator_type>	values;
+
+		flat_storage(const Alloc &alloc): keys(key_allocator_type(alloc)), values(mapped_allocator_type(alloc))
+		{
+
+		}
+
+		flat_storage(const flat_storage &x): keys(x.keys), values(x.values)
+		{
+
+		}
+
+		size_t size() const
+		{
+			return (keys.size());
+		}
+
+		const Key &key(size_t i) const
+		{
+			return (keys[i]);
+		}
+
+		T &mapped(size_t i)
+		{
+			return (values[i]);
+		}
+
+		reference ref(size_t i)
+		{
+			return (reference(keys[i], values[i]));
+		}
+
+		const_reference ref(size_t i) const
+		{
+			return (const_reference(keys[i], values[i]));
+		}
+
+		pointer ptr(size_t i)
+		{
+			return (pointer(ref(i)));
+		}
+
+		const_pointer ptr(size_t i) const
+		{
+			return (const_pointer(ref(i)));
+		}
+
+		void push_back(const Key &k, const T &v)
+		{
+			keys.push_back(k);
+			values.push_back(v);
+		}
+
+		void insert(size_t i, const Key &k, const T &v)
+		{
+			size_t n = keys.size();
+			Key key(k);
+			T value(v);
+
+			if (i < n)
+			{
+				Key last_key(keys[n - 1]);
+				T last_value(values[n - 1]);
+				keys.push_back(last_key);
+				values.push_back(last_value);
+				for (size_t j = n - 1; j > i; j--)
+				{
+					keys[j] = keys[j - 1];
+					values[j] = values[j - 1];
+				}
+				keys[i] = key;
+				values[i] = value;
+			}
+			else
+				push_back(key, value);
+		}
+
+		void erase(size_t first, size_t last)
+		{
+			keys.erase(keys.begin() + first, keys.begin() + last);
+			values.erase(values.begin() + first, values.begin() + last);
+		}
+
+		void reserve(size_t n)
+		{
+			keys.reserve(n);
+			values.reserve(n);
+		}
+
+		size_t capacity() const
+		{
+			return (keys.capacity());
+		}
+
+		void clear()
+		{
+			keys.clear();
+			values.clear();
+		}
+
+		void swap(flat_storage &x)
+		{
+			keys.swap(x.keys);
+			values.swap(x.values);
+		}
+	};
+
+	//Sorted array with the lookups of ft::map, for maps built once and read
+	//a lot. Inserting or erasing one element shifts everything after it,
+	//insert(first, last) sorts the new elements and merges them in a single
+	//pass instead. Split stores keys and values in separate vectors.
+	//Keys are stored mutable: changing one through an iterator breaks the
+	//order.
+	template <class Key, class T, class Compare = std::less<Key>, class Alloc = std::allocator<ft::pair<Key,T> >, bool Split = false>
+	class flat_map
+	{
+		public:
+			typedef Key 																	key_type;
+			typedef T 																		mapped_type;
+			typedef ft::pair<key_type,mapped_type> 											value_type;
+			typedef Compare 																key_compare;
+			typedef Alloc 																	allocator_type;
+			typedef ft::flat_storage<Key, T, Alloc, Split>									storage_type;
+			typedef typename storage_type::reference										reference;
+			typedef typename storage_type::const_reference									const_reference;
+			typedef typename storage_type::pointer											pointer;
+			typedef typename storage_type::const_pointer									const_pointer;
+			typedef ft::flat_iterator<storage_type, value_type, reference, pointer>			iterator;
+			typedef ft::flat_iterator<const storage_type, value_type, const_reference, const_pointer>	const_iterator;
+			typedef ft::reverse_iterator<iterator> 											reverse_iterator;
+			typedef ft::reverse_iterator<const_iterator>									const_reverse_iterator;
+			typedef std::ptrdiff_t 															difference_type;
+			typedef size_t 																	size_type;
+
+		private:
+			key_compare		_compare;
+			allocator_type	_alloc;
+			storage_type	_storage;
+
+			//Orders the pairs waiting to be merged by key
+			struct pair_compare
+			{
+				Compare comp;
+
+				pair_compare(Compare c): comp(c)
+				{
+
+				}
+
+				bool operator()(const value_type &x, const value_type &y) const
+				{
+					return (comp(x.first, y.first));
+				}
+			};
+
+		public:
+
+			class value_compare
+			{
+				friend class flat_map;
+
+				protected:
+
+					Compare comp;
+
+					value_compare(Compare c): comp(c)
+					{
+
+					}
+
+				public:
+
+					typedef bool result_type;
+					typedef value_type first_argument_type;
+					typedef value_type second_argument_type;
+
+					bool operator()(const value_type &x, const value_type &y) const
+					{
+						return (comp(x.first, y.first));
+					}
+			};
+
+		flat_map(const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type()): _compare(comp), _alloc(alloc), _storage(alloc)
+		{
+
+		}
+
+		template <class InputIterator>
+		flat_map(InputIterator first, InputIterator last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type()): _compare(comp), _alloc(alloc), _storage(alloc)
+		{
+			insert(first, last);
+		}
+
+		flat_map(const flat_map &x): _compare(x._compare), _alloc(x._alloc), _storage(x._storage)
+		{
+
+		}
+
+		~flat_map()
+		{
+
+		}
+
+		flat_map& operator=(const flat_map& x)
+		{
+			if (this == &x)
+				return (*this);
+			storage_type copy(x._storage);
+			_compare = x._compare;
+			_storage.swap(copy);
+			return (*this);
+		}
+
+		//Iterators
+
+		iterator begin()
+		{
+			return (iterator(&_storage, 0));
+		}
+
+		const_iterator begin() const
+		{
+			return (const_iterator(&_storage, 0));
+		}
+
+		iterator end()
+		{
+			return (iterator(&_storage, _storage.size()));
+		}
+
+		const_iterator end() const
+		{
+			return (const_iterator(&_storage, _storage.size()));
+		}
+
+		reverse_iterator rbegin()
+		{
+			return (reverse_iterator(end()));
+		}
+
+		const_reverse_iterator rbegin() const
+		{
+			return (const_reverse_iterator(end()));
+		}
+
+		reverse_iterator rend()
+		{
+			return (reverse_iterator(begin()));
+		}
+
+		const_reverse_iterator rend() const
+		{
+			return (const_reverse_iterator(begin()));
+		}
+
+		//Capacity
+
+		bool empty() const
+		{
+			return (_storage.size() == 0);
+		}
+
+		size_type size() const
+		{
+			return (_storage.size());
+		}
+
+		size_type max_size() const
+		{
+			return (std::numeric_limits<size_type>::max() / sizeof(value_type));
+		}
+
+		size_type capacity() const
+		{
+			return (_storage.capacity());
+		}
+
+		void reserve(size_type n)
+		{
+			_storage.reserve(n);
+		}
+
+		//Observers
+
+		key_compare key_comp() const
+		{
+			return (_compare);
+		}
+
+		value_compare value_comp() const
+		{
+			return (value_compare(_compare));
+		}
+
+		//Element access
+
+		mapped_type& operator[](const key_type& k)
+		{
+			size_t pos = lowerIndex(k);
+
+			if (pos == _storage.size() || _compare(k, _storage.key(pos)))
+				_storage.insert(pos, k, mapped_type());
+			return (_storage.mapped(pos));
+		}
+
+		//Modifiers
+
+		ft::pair<iterator,bool> insert(const value_type& val)
+		{
+			size_t pos = lowerIndex(val.first);
+
+			if (pos < _storage.size() && !_compare(val.first, _storage.key(pos)))
+				return (ft::make_pair(iterator(&_storage, pos), false));
+			_storage.insert(pos, val.first, val.second);
+			return (ft::make_pair(iterator(&_storage, pos), true));
+		}
+
+		//The hint is taken when val belongs right before it, which makes
+		//appending in order skip the search
+		iterator insert(iterator position, const value_type& val)
+		{
+			size_t pos = position.get_pos();
+			size_t n = _storage.size();
+
+			if ((pos == n || _compare(val.first, _storage.key(pos))) && (pos == 0 || _compare(_storage.key(pos - 1), val.first)))
+			{
+				_storage.insert(pos, val.first, val.second);
+				return (iterator(&_storage, pos));
+			}
+			return (insert(val).first);
+		}
+
+		//The new elements are sorted apart, then merged with the current ones
+		//into a new array, O(n + m log m) whatever their order. They only get
+		//appended when they all come after the current ones.
+		template <class InputIterator>
+		void insert(InputIterator first, InputIterator last)
+		{
+			ft::vector<value_type> incoming;
+
+			for (; first != last; ++first)
+				incoming.push_back(value_type((*first).first, (*first).second));
+			if (incoming.empty())
+				return ;
+			std::stable_sort(incoming.data(), incoming.data() + incoming.size(), pair_compare(_compare));
+			size_t n = _storage.size();
+			size_t m = incoming.size();
+			if (n == 0 || _compare(_storage.key(n - 1), incoming[0].first))
+			{
+				_storage.reserve(n + m);
+				for (size_t j = 0; j < m; j = nextKey(incoming, j))
+					_storage.push_back(incoming[j].first, incoming[j].second);
+				return ;
+			}
+			storage_type merged(_alloc);
+			size_t i = 0;
+			size_t j = 0;
+			merged.reserve(n + m);
+			while (i < n || j < m)
+			{
+				if (j == m || (i < n && _compare(_storage.key(i), incoming[j].first)))
+				{
+					merged.push_back(_storage.key(i), _storage.mapped(i));
+					i++;
+				}
+				else if (i == n || _compare(incoming[j].first, _storage.key(i)))
+				{
+					merged.push_back(incoming[j].first, incoming[j].second);
+					j = nextKey(incoming, j);
+				}
+				else
+					j = nextKey(incoming, j);
+			}
+			_storage.swap(merged);
+		}
+
+		void erase(iterator position)
+		{
+			_storage.erase(position.get_pos(), position.get_pos() + 1);
+		}
+
+		size_type erase(const key_type& k)
+		{
+			size_t pos = lowerIndex(k);
+
+			if (pos == _storage.size() || _compare(k, _storage.key(pos)))
+				return (0);
+			_storage.erase(pos, pos + 1);
+			return (1);
+		}
+
+		void erase(iterator first, iterator last)
+		{
+			_storage.erase(first.get_pos(), last.get_pos());
+		}
+
+		void swap(flat_map &x)
+		{
+			if (&x == this)
+				return ;
+			_storage.swap(x._storage);
+			std::swap(_compare, x._compare);
+			std::swap(_alloc, x._alloc);
+		}
+
+		void clear()
+		{
+			_storage.clear();
+		}
+
+		//Operations
+
+		iterator find(const key_type& k)
+		{
+			size_t pos = lowerIndex(k);
+
+			if (pos == _storage.size() || _compare(k, _storage.key(pos)))
+				return (end());
+			return (iterator(&_storage, pos));
+		}
+
+		const_iterator find(const key_type& k) const
+		{
+			size_t pos = lowerIndex(k);
+
+			if (pos == _storage.size() || _compare(k, _storage.key(pos)))
+				return (end());
+			return (const_iterator(&_storage, pos));
+		}
+
+		size_type count(const key_type& k) const
+		{
+			size_t pos = lowerIndex(k);
+
+			return (pos < _storage.size() && !_compare(k, _storage.key(pos)));
+		}
+
+		iterator lower_bound(const key_type& k)
+		{
+			return (iterator(&_storage, lowerIndex(k)));
+		}
+
+		const_iterator lower_bound(const key_type& k) const
+		{
+			return (const_iterator(&_storage, lowerIndex(k)));
+		}
+
+		iterator upper_bound(const key_type& k)
+		{
+			return (iterator(&_storage, upperIndex(k)));
+		}
+
+		const_iterator upper_bound(const key_type& k) const
+		{
+			return (const_iterator(&_storage, upperIndex(k)));
+		}
+
+		ft::pair<iterator,iterator> equal_range(const key_type& k)
+		{
+			size_t pos = lowerIndex(k);
+			size_t last = pos;
+
+			if (pos < _storage.size() && !_compare(k, _storage.key(pos)))
+				last++;
+			return (ft::make_pair(iterator(&_storage, pos), iterator(&_storage, last)));
+		}
+
+		ft::pair<const_iterator,const_iterator> equal_range(const key_type& k) const
+		{
+			size_t pos = lowerIndex(k);
+			size_t last = pos;
+
+			if (pos < _storage.size() && !_compare(k, _storage.key(pos)))
+				last++;
+			return (ft::make_pair(const_iterator(&_storage, pos), const_iterator(&_storage, last)));
+		}
+
+		//Allocator
+
+		allocator_type get_allocator(void) const
+		{
+			allocator_type allocator_copy(_alloc);
+			return (allocator_copy);
+		}
+
+		private :
+
+		//First index whose key is not less than k
+		size_t lowerIndex(const key_type &k) const
+		{
+			size_t low = 0;
+			size_t high = _storage.size();
+
+			while (low < high)
+			{
+				size_t mid = low + (high - low) / 2;
+				if (_compare(_storage.key(mid), k))
+					low = mid + 1;
+				else
+					high = mid;
+			}
+			return (low);
+		}
+
+		//First index whose key is greater than k
+		size_t upperIndex(const key_type &k) const
+		{
+			size_t low = 0;
+			size_t high = _storage.size();
+
+			while (low < high)
+			{
+				size_t mid = low + (high - low) / 2;
+				if (_compare(k, _storage.key(mid)))
+					high = mid;
+				else
+					low = mid + 1;
+			}
+			return (low);
+		}
+
+		//Skips the elements of a sorted run that repeat the key at j, the
+		//first one wins like it does with insert()
+		size_t nextKey(const ft::vector<value_type> &sorted, size_t j) const
+		{
+			size_t k = j + 1;
+
+			while (k < sorted.size() && !_compare(sorted[j].first, sorted[k].first))
+				k++;
+			return (k);
+		}
+	};
+
+	template<class Key, class T, class Compare, class Alloc, bool Split>
+	bool operator==(const ft::flat_map<Key,T,Compare,Alloc,Split> &lhs, const ft::flat_map<Key,T,Compare,Alloc,Split> &rhs)
+	{
+		if (lhs.size() != rhs.size())
+			return false;
+		return (ft::equal(lhs.begin(), lhs.end(), rhs.begin()));
+	}
+
+	template<class Key, class T, class Compare, class Alloc, bool Split>
+	bool operator!=(const ft::flat_map<Key,T,Compare,Alloc,Split> &lhs, const ft::flat_map<Key,T,Compare,Alloc,Split> &rhs)
+	{
+		return !(rhs == lhs);
+	}
+
+	template<class Key, class T, class Compare, class Alloc, bool Split>
+	bool operator< (const ft::flat_map<Key,T,Compare,Alloc,Split> &lhs, const ft::flat_map<Key,T,Compare,Alloc,Split> &rhs)
+	{
+		return (ft::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end()));
+	}
+
+	template<class Key, class T, class Compare, class Alloc, bool Split>
+	bool operator<=(const ft::flat_map<Key,T,Compare,Alloc,Split> &lhs, const ft::flat_map<Key,T,Compare,Alloc,Split> &rhs)
+	{
+		return !(lhs > rhs);
+	}
+
+	template<class Key, class T, class Compare, class Alloc, bool Split>
+	bool operator> (const ft::flat_map<Key,T,Compare,Alloc,Split> &lhs, const ft::flat_map<Key,T,Compare,Alloc,Split> &rhs)
+	{
+		return rhs < lhs;
+	}
+
+	template<class Key, class T, class Compare, class Alloc, bool Split>
+	bool operator>=(const ft::flat_map<Key,T,Compare,Alloc,Split> &lhs, const ft::flat_map<Key,T,Compare,Alloc,Split> &rhs)
+	{
+		return !(lhs < rhs);
+	}
+
+	template<class Key, class T, class Compare, class Alloc, bool Split>
+	void swap(ft::flat_map<Key,T,Compare,Alloc,Split> &lhs, ft::flat_map<Key,T,Compare,Alloc,Split> &rhs)
+	{
+		return lhs.swap(rhs);
+	}
+}
+
+#endif
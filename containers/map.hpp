@@ -1,14 +1,44 @@
 #ifndef MAP_HPP
 # define MAP_HPP
 
+#include <stdexcept>
 #include "../iterators/utils.hpp"
 #include "../iterators/BSTNode.hpp"
+#include "../iterators/pool_allocator.hpp"
 #include "../iterators/bidirectional_iterator.hpp"
 #include "../iterators/reverse_iterator.hpp"
 
 namespace ft
 {
-	template <class Key, class T, class Compare = std::less<Key>, class Alloc = std::allocator<ft::pair<const Key,T> > >
+	//Work done by the balancing code, for debugging and benchmarks
+	struct tree_stats
+	{
+		size_t	rotations;
+		size_t	visited;
+
+		tree_stats(): rotations(0), visited(0)
+		{
+
+		}
+	};
+
+	//Options of the tree behind ft::map, the defaults give the plain AVL tree.
+	//Augment is mixed into every node, Compact packs the height of the nodes
+	//into their links, see BSTNode.hpp.
+	template <class Augment = no_augment, bool Compact = false>
+	struct tree_policy
+	{
+		typedef Augment		augment_type;
+		static const bool	compact = Compact;
+	};
+
+	//Lets nth(), rank() and count_range() run in O(log n)
+	typedef tree_policy<subtree_size>		order_statistic_policy;
+
+	//Nodes one word smaller, at the cost of masking every link they follow
+	typedef tree_policy<no_augment, true>	compact_policy;
+
+	template <class Key, class T, class Compare = std::less<Key>, class Alloc = std::allocator<ft::pair<const Key,T> >, class Policy = ft::tree_policy<> >
 	class map
 	{
 		public:
@@ -21,7 +51,9 @@ namespace ft
 			typedef typename allocator_type::const_reference 					const_reference;
 			typedef typename allocator_type::pointer 							pointer;
 			typedef typename allocator_type::const_pointer 						const_pointer;
-			typedef BSTNode<value_type>											map_node;
+			typedef Policy														policy_type;
+			typedef typename Policy::augment_type								augment_type;
+			typedef BSTNode<value_type, augment_type, Policy::compact>			map_node;
 			typedef ft::bidirectionnal_iterator<map_node, value_type>						iterator;
 			typedef ft::const_bidirectionnal_iterator<map_node, const value_type, iterator>	const_iterator;
 			typedef ft::reverse_iterator<iterator> 							reverse_iterator;
@@ -38,6 +70,7 @@ namespace ft
 			map_node			*_end;
 			map_node			*_begin;
 			size_type			_size;
+			tree_stats			_stats;
 
 		public:
 
@@ -66,7 +99,7 @@ namespace ft
 					}
 			};
 
-		map (const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type()): _compare(comp), _alloc(alloc), _node_alloc(std::allocator<map_node>()), _root(NULL), _end(NULL), _begin(NULL), _size(0)
+		map (const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type()): _compare(comp), _alloc(alloc), _node_alloc(alloc), _root(NULL), _end(NULL), _begin(NULL), _size(0)
 		{
 			_end = _node_alloc.allocate(1);
 			_node_alloc.construct(_end, map_node());
@@ -77,7 +110,7 @@ namespace ft
 		}
 
 		template <class InputIterator>
-		map (InputIterator first, InputIterator last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type()): _compare(comp), _alloc(alloc), _node_alloc(std::allocator<map_node>()), _root(NULL), _size(0)
+		map (InputIterator first, InputIterator last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type()): _compare(comp), _alloc(alloc), _node_alloc(alloc), _root(NULL), _size(0)
 		{
 			_end = _node_alloc.allocate(1);
 			_node_alloc.construct(_end, map_node());
@@ -97,9 +130,9 @@ namespace ft
 			_node_alloc.construct(_begin, map_node());
 
 			_begin->parent = _end;
-			clear();
-
-			this->insert(x.begin(), x.end());
+			map_node *spare = NULL;
+			_root = cloneTree(x._root, NULL, x, spare);
+			_size = x._size;
 		}
 
 		~map()
@@ -111,14 +144,17 @@ namespace ft
 			_node_alloc.deallocate(_begin, 1);
 		}
 
+		//The nodes already owned are recycled for the copy, only the count
+		//difference goes through the allocator
 		map& operator=(const map& x)
 		{
-			clear();
+			if (this == &x)
+				return (*this);
+			map_node *spare = detachNodes();
 			_compare = x._compare;
-			_size = 0;
-			_alloc = x._alloc;
-			_node_alloc = x._node_alloc;
-			insert(x.begin(), x.end());
+			_root = cloneTree(x._root, NULL, x, spare);
+			_size = x._size;
+			releaseNodes(spare);
 			return (*this);
 		}
 
@@ -156,12 +192,12 @@ namespace ft
 
 		reverse_iterator rend()
 		{
-			return (reverse_iterator(_begin->parent));
+			return (reverse_iterator(begin()));
 		}
 
 		const_reverse_iterator rend() const
 		{
-			return (const_reverse_iterator(_begin->parent));
+			return (const_reverse_iterator(begin()));
 		}
 
 		//Capacity
@@ -199,88 +235,106 @@ namespace ft
 
 		mapped_type& operator[](const key_type& k)
 		{
-			return (*(this->insert(value_type(k, mapped_type())).first)).second;
+			map_node *parent;
+			bool left;
+			map_node *node = findSlot(k, parent, left);
+
+			if (!node)
+				node = insertAt(parent, left, value_type(k, mapped_type()));
+			return (node->value.second);
 		}
 
 		//Modifiers
 
 		pair<iterator,bool> insert (const value_type& val)
 		{
-			if (!_root)
+			map_node *parent;
+			bool left;
+			map_node *node = findSlot(val.first, parent, left);
+
+			if (node)
+				return (ft::make_pair(iterator(node), false));
+			return (ft::make_pair(iterator(insertAt(parent, left, val)), true));
+		}
+
+		//The hint is used when val belongs right before or right after it,
+		//the node is then linked there without searching the tree
+		iterator insert (iterator position, const value_type& val)
+		{
+			map_node *hint = position.get_internal_pointer();
+
+			if (!_root || !hint)
+				return (insert(val).first);
+			if (hint == _end)
 			{
-				_root = _node_alloc.allocate(1);
-				_node_alloc.construct(_root, map_node(val));
-				_root->left = _begin;
-				_root->right = _end;
-				_end->parent = _root;
-				_begin->parent = _root;
-				_size = 1;
-				return (ft::make_pair(iterator(_root), true));
-			}
-			iterator it = this->find(val.first);
-			if (it != this->end())
-				return (ft::make_pair(it, false));
-			map_node *node;
-			if (_compare(_end->parent->value.first, val.first))
-				node = _end->parent;
-			else if (!_compare(_begin->parent->value.first, val.first))
-				node = _begin->parent;
-			else
-				node = _root;			
-			while (node->right || node->left)
+				if (_compare(_end->parent->value.first, val.first))
+					return (iterator(insertAt(_end->parent, false, val)));
+			}
+			else if (_compare(val.first, hint->value.first))
 			{
-				if (_compare(node->value.first, val.first))
+				if (hint == _begin->parent)
+					return (iterator(insertAt(hint, true, val)));
+				map_node *prev = hint->prev();
+				if (_compare(prev->value.first, val.first))
 				{
-					if (node->right && node->right != _end)
-						node = node->right;
-					else
-						break ;
-				}
-				else
-				{
-					if (node->left && node->left != _begin)
-						node = node->left;
-					else
-						break ;
+					if (isNode(hint->left))
+						return (iterator(insertAt(prev, false, val)));
+					return (iterator(insertAt(hint, true, val)));
 				}
 			}
-			map_node *new_node = _node_alloc.allocate(1);
-			_node_alloc.construct(new_node, map_node(val));
-			new_node->parent = node;
-			if (_compare(node->value.first, val.first))
+			else if (_compare(hint->value.first, val.first))
 			{
-				new_node->right = node->right;
-				if (new_node->right)
-				    new_node->right->parent = new_node;
-				new_node->left = NULL;
-				node->right = new_node;
+				map_node *next = hint->next();
+				if (next == _end || _compare(val.first, next->value.first))
+				{
+					if (isNode(hint->right))
+						return (iterator(insertAt(next, true, val)));
+					return (iterator(insertAt(hint, false, val)));
+				}
 			}
 			else
-			{
-				new_node->left = node->left;
-				if (new_node->left)
-					new_node->left->parent = new_node;
-				new_node->right = NULL;
-				node->left = new_node;
-			}
-			_size++;
-			if (_size >= 3)
-				rebalance(new_node);
-			return ft::make_pair(new_node, true);
-		}
-
-		iterator insert (iterator position, const value_type& val)
-		{
-			(void) position;
+				return (iterator(hint));
 			return (insert(val).first);
 		}
 
+		//An empty map fed with increasing keys is built in one pass, whatever
+		//is left once the keys stop increasing goes through the hinted insert
 		template <class InputIterator>
 		void insert (InputIterator first, InputIterator last)
 		{
+			if (!_root && first != last)
+			{
+				map_node *head = NULL;
+				map_node *tail = NULL;
+				size_type n = 0;
+
+				while (first != last)
+				{
+					if (tail && !_compare(tail->value.first, (*first).first))
+					{
+						if (_compare((*first).first, tail->value.first))
+							break ;
+					}
+					else
+					{
+						map_node *node = createNode(*first);
+						if (tail)
+							tail->right = node;
+						else
+							head = node;
+						tail = node;
+						n++;
+					}
+					first++;
+				}
+				_root = buildSorted(head, n);
+				_root->parent = NULL;
+				_size = n;
+				wireSentinels();
+			}
 			while (first != last)
 			{
-				insert(*first);
+				insert(end(), *first);
 				first++;
 			}
 		}
@@ -288,176 +342,73 @@ namespace ft
 		void erase(iterator position)
 		{
 			map_node *p = position.get_internal_pointer();
-			map_node *tmp;
 			map_node *toBalance;
 
-			if (p == _root)
+			if (_size == 1)
 			{
-				if (p->right && !p->left)
-				{
-					p->right->parent = NULL;
-					_root = p->right;
-				}
-				else if (!p->right && p->left)
-				{
-					p->left->parent = NULL;
-					_root = p->left;
-				}
-				else if (p->right && p->left)
+				_node_alloc.destroy(p);
+				_node_alloc.deallocate(p, 1);
+				_size = 0;
+				_root = NULL;
+				_begin->left = NULL;
+				_begin->right = NULL;
+				_end->left = NULL;
+				_end->right = NULL;
+				_begin->parent = _end;
+				return ;
+			}
+			if (!isNode(p->left) || !isNode(p->right))
+			{
+				map_node *child = isNode(p->left) ? p->left : (isNode(p->right) ? p->right : NULL);
+				replaceChild(p, child);
+				if (child)
+					child->parent = p->parent;
+				if (p->left == _begin)
 				{
-					if (p->right != _end)
-					{
-						tmp = p->findMin(p->right);
-						if (tmp->parent != p)
-							toBalance = tmp->parent;
-						else
-							toBalance = tmp;
-						tmp->left = p->left;
-						p->left->parent = tmp;
-						if (tmp != p->right)
-						{
-							tmp->right = p->right;
-							p->right->parent = tmp;
-						}
-						if (tmp->parent)
-						{
-							if (tmp->parent->left == tmp)
-								tmp->parent->left = NULL;
-							else
-								tmp->parent->right = NULL;
-						}
-						tmp->parent = NULL;
-						_root = tmp;
-					}
-					else if (p->left != _begin)
-					{
-						p->left->parent = NULL;
-						tmp = p->findMax(p->left);
-						if (tmp->parent != p)
-							toBalance = tmp->parent;
-						else
-							toBalance = tmp;
-						tmp->left = p->left;
-						if (p->right->parent)
-							p->right->parent = tmp;
-						tmp->right = p->right;
-						if (p->left)
-							p->left->parent = tmp;
-						if (tmp->parent)
-						{
-							if (tmp->parent->left == tmp)
-								tmp->parent->left = NULL;
-							else
-								tmp->parent->right = NULL;
-						}
-						tmp->parent = NULL;
-						_root = tmp;
-					}
-					else
-					{
-						_begin->parent = _end;
-						_end->left = _begin;
-						_root = NULL;
-					}
+					map_node *min = p->parent;
+
+					if (child)
+						min = child->findMin(child);
+					min->left = _begin;
+					_begin->parent = min;
 				}
-				else
+				if (p->right == _end)
 				{
-					_begin->parent = _end;
-					_root = NULL;
+					map_node *max = p->parent;
+
+					if (child)
+						max = child->findMax(child);
+					max->right = _end;
+					_end->parent = max;
 				}
-			}
-			else if (!p->right && !p->left)
-			{
-				if (p->parent->right == p)
-					p->parent->right = NULL;
-				else
-					p->parent->left = NULL;
-				toBalance = p->parent;
-			}
-			else if (!p->right && p->left)
-			{
-				if (p->parent->right == p)
-					p->parent->right = p->left;
-				else
-					p->parent->left = p->left;
-				p->left->parent = p->parent;
-				toBalance = p->parent;
-			}
-			else if (p->right && !p->left)
-			{
-				if (p->parent->right == p)
-					p->parent->right = p->right;
-				else
-					p->parent->left = p->right;
-				p->right->parent = p->parent;
 				toBalance = p->parent;
 			}
 			else
 			{
-				if (p->left == _begin)
+				//p is neither the min nor the max, its successor takes its place
+				map_node *succ = p->findMin(p->right);
+
+				if (succ != p->right)
 				{
-					p->parent->left = p->right;
-					p->right->parent = p->parent;
-					map_node *tmp = p->findMin(p->right);
-					tmp->left = p->left;
-					p->left->parent = tmp;
-					toBalance = p->parent;
+					toBalance = succ->parent;
+					succ->parent->left = succ->right;
+					if (succ->right)
+						succ->right->parent = succ->parent;
+					succ->right = p->right;
+					p->right->parent = succ;
 				}
 				else
-				{
-					map_node *max_left = p->findMax(p->left);
-					if (!max_left->left && !max_left->right)
-					{
-						if (max_left == max_left->parent->left)
-							max_left->parent->left = NULL;
-						else
-							max_left->parent->right = NULL;
-						max_left->parent = NULL;
-					}
-					else if (max_left->left && !max_left->right)
-					{
-						if (max_left == max_left->parent->left)
-							max_left->parent->left = max_left->left;
-						else
-							max_left->parent->right = max_left->left;
-						max_left->left->parent = max_left->parent;
-					}
-					else if (!max_left->left && max_left->right)
-					{
-						if (max_left == max_left->parent->left)
-							max_left->parent->left = max_left->right;
-						else
-							max_left->parent->right = max_left->right;
-						max_left->right->parent = max_left->parent;
-					}
-					max_left->parent = p->parent;
-					if (p->parent->left == p)
-						p->parent->left = max_left;
-					else
-						p->parent->right = max_left;
-					max_left->left = p->left;
-					if (p->left)
-						p->left->parent = max_left;
-					max_left->right = p->right;
-					if (p->right)
-						p->right->parent = max_left;
-					toBalance = max_left;
-				}
+					toBalance = succ;
+				succ->left = p->left;
+				p->left->parent = succ;
+				replaceChild(p, succ);
+				succ->parent = p->parent;
+				succ->set_height(p->get_height());
 			}
 			_node_alloc.destroy(p);
 			_node_alloc.deallocate(p, 1);
 			_size--;
-			if (_size == 0)
-			{
-				_root = NULL;
-				_begin->right = NULL;
-				_begin->left = NULL;
-				_end->right = NULL;
-				_end->left = NULL;
-				_begin->parent = _end;
-			}
-			else if (_size >= 3)
-				rebalance(toBalance);
+			rebalance(toBalance);
 		}
 
 		size_type erase (const key_type &k)
@@ -469,17 +420,124 @@ namespace ft
 			return (1);
 		}
 
+		//The range is cut out with two splits, freed in post-order and the
+		//two remaining parts are joined back: O(k + log n)
 		void erase(iterator first, iterator last)
 		{
-			iterator tmp;
-
 			if (first == last)
+				return ;
+			if (first == begin() && last == end())
+			{
+				clear();
+				return ;
+			}
+			map_node *lo = first.get_internal_pointer();
+			map_node *hi = last.get_internal_pointer();
+			map_node *left;
+			map_node *middle;
+			map_node *right = NULL;
+
+			unwireSentinels();
+			splitTree(_root, lo->value.first, left, middle);
+			if (hi != _end)
+				splitTree(middle, hi->value.first, middle, right);
+			_size -= releaseNodes(chainTree(middle));
+			_root = joinTrees(left, right);
+			wireSentinels();
+		}
+
+		//Moves the keys not less than k to the returned map, which shares the
+		//allocator. The cut costs O(log n); without subtree sizes in the
+		//nodes, the sizes of the two parts come from walking both in step
+		//until the smaller one ends.
+		map split(const key_type& k)
+		{
+			map upper(_compare, _alloc, _node_alloc);
+			map_node *left;
+			map_node *right;
+
+			if (!_root)
+				return (upper);
+			unwireSentinels();
+			splitTree(_root, k, left, right);
+			size_type n = treeSize(left, right, _size, static_cast<augment_type *>(NULL));
+			_root = left;
+			upper._root = right;
+			upper._size = _size - n;
+			_size = n;
+			wireSentinels();
+			upper.wireSentinels();
+			return (upper);
+		}
+
+		//Takes every node of x, whose keys must all be smaller or all be
+		//bigger than the ones of this map, and leaves x empty. The trees are
+		//glued with one AVL join, O(log n). Nodes from an allocator that
+		//cannot free them here are copied instead.
+		void join(map &x)
+		{
+			if (&x == this || x._size == 0)
+				return ;
+			bool after = _size == 0 || _compare(_end->parent->value.first, x._begin->parent->value.first);
+			bool before = _size == 0 || _compare(x._end->parent->value.first, _begin->parent->value.first);
+			if (!after && !before)
+				throw std::invalid_argument("map::join: key ranges overlap");
+			if (_node_alloc != x._node_alloc)
 			{
+				insert(x.begin(), x.end());
+				x.clear();
 				return ;
 			}
-			tmp = first;
-			erase(++first, last);
-			erase(tmp);
+			unwireSentinels();
+			x.unwireSentinels();
+			if (after)
+				_root = joinTrees(_root, x._root);
+			else
+				_root = joinTrees(x._root, _root);
+			_size += x._size;
+			x._root = NULL;
+			x._size = 0;
+			x.wireSentinels();
+			wireSentinels();
+		}
+
+#if __cplusplus >= 201103L
+		void join(map &&x)
+		{
+			join(x);
+		}
+#endif
+
+		//Set algebra on the keys, by splitting this tree around the nodes of
+		//x and joining the pieces back: O(m log(n / m + 1)) for sizes m <= n
+		//in either order. x is only read, this map keeps its own value when
+		//both have a key.
+
+		void merge_union(const map &x)
+		{
+			if (&x == this)
+				return ;
+			unwireSentinels();
+			_root = unionTree(_root, x._root, x);
+			wireSentinels();
+		}
+
+		void intersect(const map &x)
+		{
+			if (&x == this)
+				return ;
+			unwireSentinels();
+			_root = intersectTree(_root, x._root, x);
+			wireSentinels();
+		}
+
+		void subtract(const map &x)
+		{
+			if (&x == this)
+				return (clear());
+			unwireSentinels();
+			_root = subtractTree(_root, x._root, x);
+			wireSentinels();
 		}
 
 		void swap(map &x)
@@ -487,7 +545,7 @@ namespace ft
 			map_node	*tmp;
 			size_type	size_tmp;
 
-			if (x == *this)
+			if (&x == this)
 				return ;
 
 			tmp = x._root;
@@ -505,143 +563,788 @@ namespace ft
 			size_tmp = x._size;
 			x._size = _size;
 			_size = size_tmp;
+
+			std::swap(_compare, x._compare);
+			std::swap(_alloc, x._alloc);
+			std::swap(_node_alloc, x._node_alloc);
 		}
 
 		void clear(void)
 		{
-			this->erase(this->begin(), this->end());
+			releaseNodes(detachNodes());
+		}
+
+		//Gives the allocator's empty slabs back, if it keeps any
+		size_type trim(void)
+		{
+			return (ft::pool_trim(_node_alloc));
 		}
 
 		//Operations
 
 		iterator find(const key_type &k)
 		{
-			map_node *node;
+			map_node *parent;
+			bool left;
+			map_node *node = findSlot(k, parent, left);
 
-			node = _root;
-			while (node && node != _end && node != _begin && (_compare(node->value.first, k) || _compare(k, node->value.first)))
+			return (iterator(node ? node : _end));
+		}
+
+		const_iterator find(const key_type &k) const
+		{
+			map_node *parent;
+			bool left;
+			map_node *node = findSlot(k, parent, left);
+
+			return (const_iterator(node ? node : _end));
+		}
+
+		size_type count (const key_type& k) const
+		{
+			if (find(k) == end())
+				return (0);
+			return (1);
+		}
+
+		iterator lower_bound (const key_type& k)
+		{
+			return (iterator(_lower_bound(k)));
+		}
+
+		const_iterator lower_bound (const key_type& k) const
+		{
+			return (const_iterator(_lower_bound(k)));
+		}
+
+		iterator upper_bound (const key_type& k)
+		{
+			return (iterator(_upper_bound(k)));
+		}
+
+		const_iterator upper_bound (const key_type& k) const
+		{
+			return (const_iterator(_upper_bound(k)));
+		}
+
+		pair<iterator,iterator> equal_range (const key_type& k)
+		{
+			pair<map_node*, map_node*> range = _equal_range(k);
+			return (ft::make_pair(iterator(range.first), iterator(range.second)));
+		}
+
+		pair<const_iterator,const_iterator> equal_range (const key_type& k) const
+		{
+			pair<map_node*, map_node*> range = _equal_range(k);
+			return (ft::make_pair(const_iterator(range.first), const_iterator(range.second)));
+		}
+
+		//Order statistics, need a policy whose augment is subtree_size
+
+		//n-th element in key order counting from 0, end() when n >= size()
+		iterator nth(size_type n)
+		{
+			return (iterator(_nth(n)));
+		}
+
+		const_iterator nth(size_type n) const
+		{
+			return (const_iterator(_nth(n)));
+		}
+
+		//Number of keys smaller than k
+		size_type rank(const key_type &k) const
+		{
+			map_node *node = _root;
+			size_type ret = 0;
+
+			while (isNode(node))
 			{
 				if (_compare(node->value.first, k))
+				{
+					ret += subtreeSize(node->left) + 1;
+					node = node->right;
+				}
+				else
+					node = node->left;
+			}
+			return (ret);
+		}
+
+		//Number of keys in [lo, hi)
+		size_type count_range(const key_type &lo, const key_type &hi) const
+		{
+			if (!_compare(lo, hi))
+				return (0);
+			return (rank(hi) - rank(lo));
+		}
+
+		map_node*	get_root(void)
+		{
+			return _root;
+		}
+
+		//Debug
+
+		const tree_stats &stats(void) const
+		{
+			return (_stats);
+		}
+
+		void reset_stats(void)
+		{
+			_stats = tree_stats();
+		}
+
+		int height(void) const
+		{
+			if (!_root)
+				return (-1);
+			return (_root->get_height());
+		}
+
+		//Allocator
+
+		allocator_type get_allocator(void) const
+		{
+			allocator_type allocator_copy(_alloc);
+			return (allocator_copy);
+		}
+
+		private :
+
+		//For split(): the result has to free its nodes into the same pool
+		map(const key_compare& comp, const allocator_type& alloc, const node_allocator_type& node_alloc): _compare(comp), _alloc(alloc), _node_alloc(node_alloc), _root(NULL), _size(0)
+		{
+			_end = _node_alloc.allocate(1);
+			_node_alloc.construct(_end, map_node());
+
+			_begin = _node_alloc.allocate(1);
+			_node_alloc.construct(_begin, map_node());
+			_begin->parent = _end;
+		}
+
+		//Number of nodes under root, other holds the rest of the total
+		size_type treeSize(map_node *root, map_node *, size_type, const subtree_size *) const
+		{
+			return (root ? subtreeSize(root) : 0);
+		}
+
+		size_type treeSize(map_node *root, map_node *other, size_type total, const void *) const
+		{
+			map_node *a = root ? root->findMin(root) : NULL;
+			map_node *b = other ? other->findMin(other) : NULL;
+			size_type n = 0;
+
+			while (a && b)
+			{
+				n++;
+				a = a->next();
+				b = b->next();
+			}
+			return (a ? total - n : n);
+		}
+
+		size_type subtreeSize(map_node *node) const
+		{
+			if (!isNode(node))
+				return (0);
+			return (node->size);
+		}
+
+		map_node *_nth(size_type n) const
+		{
+			map_node *node = _root;
+
+			if (n >= _size)
+				return (_end);
+			while (true)
+			{
+				size_type left = subtreeSize(node->left);
+				if (n < left)
+					node = node->left;
+				else if (n == left)
+					return (node);
+				else
+				{
+					n -= left + 1;
+					node = node->right;
+				}
+			}
+		}
+
+		//First node whose key is not less than k, _end if there is none
+		map_node *_lower_bound(const key_type &k) const
+		{
+			map_node *node = _root;
+			map_node *ret = _end;
+
+			while (node && node != _begin && node != _end)
+			{
+				if (!_compare(node->value.first, k))
+				{
+					ret = node;
+					node = node->left;
+				}
+				else
 					node = node->right;
+			}
+			return (ret);
+		}
+
+		//First node whose key is greater than k, _end if there is none
+		map_node *_upper_bound(const key_type &k) const
+		{
+			map_node *node = _root;
+			map_node *ret = _end;
+
+			while (node && node != _begin && node != _end)
+			{
+				if (_compare(k, node->value.first))
+				{
+					ret = node;
+					node = node->left;
+				}
 				else
+					node = node->right;
+			}
+			return (ret);
+		}
+
+		//Both bounds in one descent: once k is met, the upper bound is its
+		//successor, otherwise both bounds are the first node greater than k
+		pair<map_node*, map_node*> _equal_range(const key_type &k) const
+		{
+			map_node *node = _root;
+			map_node *upper = _end;
+
+			while (node && node != _begin && node != _end)
+			{
+				if (_compare(k, node->value.first))
+				{
+					upper = node;
 					node = node->left;
+				}
+				else if (_compare(node->value.first, k))
+					node = node->right;
+				else
+				{
+					if (node->right && node->right != _end)
+						upper = node->findMin(node->right);
+					return (ft::make_pair(node, upper));
+				}
 			}
-			if (node && node != _end && node != _begin && !_compare(node->value.first, k) && !_compare(k, node->value.first))
-				return iterator(node);
+			return (ft::make_pair(upper, upper));
+		}
+
+		bool isNode(map_node *node) const
+		{
+			return (node != NULL && node != _begin && node != _end);
+		}
+
+		//Puts child where node was under node's parent
+		void replaceChild(map_node *node, map_node *child)
+		{
+			if (!node->parent)
+				_root = child;
+			else if (node->parent->left == node)
+				node->parent->left = child;
 			else
-				return iterator(_end);
+				node->parent->right = child;
 		}
 
-		const_iterator find(const key_type &k) const
+		map_node *createNode(const value_type &val)
+		{
+			map_node *node = _node_alloc.allocate(1);
+
+			_node_alloc.construct(node, map_node(val));
+			return (node);
+		}
+
+		//Takes a node from the spare chain left by detachNodes() if there is
+		//one, the allocator is only asked when the chain is empty
+		map_node *recycleNode(map_node *&spare, const value_type &val)
 		{
-			map_node *node;
+			if (!spare)
+				return (createNode(val));
+			map_node *node = spare;
+			spare = spare->right;
+			_node_alloc.destroy(node);
+			_node_alloc.construct(node, map_node(val));
+			return (node);
+		}
 
-			node = _root;
-			while (node && node != _end && node != _begin && (_compare(node->value.first, k) || _compare(k, node->value.first)))
+		//Copies the shape and heights of the subtree of x rooted at src, the
+		//sentinels of x are mapped to ours
+		map_node *cloneTree(map_node *src, map_node *parent, const map &x, map_node *&spare)
+		{
+			if (src == x._begin)
 			{
-				if (_compare(node->value.first, k))
+				_begin->parent = parent;
+				return (_begin);
+			}
+			if (src == x._end)
+			{
+				_end->parent = parent;
+				return (_end);
+			}
+			if (!src)
+				return (NULL);
+			map_node *node = recycleNode(spare, src->value);
+			node->parent = parent;
+			node->left = cloneTree(src->left, node, x, spare);
+			node->right = cloneTree(src->right, node, x, spare);
+			setHeight(node);
+			return (node);
+		}
+
+		//Unhooks every node of the subtree in post-order without rebalancing
+		//nor recursion and returns them chained through right
+		map_node *chainTree(map_node *node)
+		{
+			map_node *chain = NULL;
+
+			if (node)
+				node->parent = NULL;
+			while (node)
+			{
+				if (isNode(node->left))
+					node = node->left;
+				else if (isNode(node->right))
 					node = node->right;
 				else
+				{
+					map_node *parent = node->parent;
+					if (parent && parent->left == node)
+						parent->left = NULL;
+					else if (parent)
+						parent->right = NULL;
+					node->right = chain;
+					chain = node;
+					node = parent;
+				}
+			}
+			return (chain);
+		}
+
+		//Leaves the map empty and returns all its nodes chained through right
+		map_node *detachNodes(void)
+		{
+			map_node *chain = chainTree(_root);
+
+			_root = NULL;
+			_size = 0;
+			_begin->left = NULL;
+			_begin->right = NULL;
+			_begin->parent = _end;
+			_end->left = NULL;
+			_end->right = NULL;
+			_end->parent = NULL;
+			return (chain);
+		}
+
+		size_type releaseNodes(map_node *chain)
+		{
+			size_type n = 0;
+
+			while (chain)
+			{
+				map_node *next = chain->right;
+				_node_alloc.destroy(chain);
+				_node_alloc.deallocate(chain, 1);
+				chain = next;
+				n++;
+			}
+			return (n);
+		}
+
+		//One descent with one comparison per level: the last node whose key is
+		//not greater than k is the only candidate for equality. When k is
+		//missing, parent and left tell where a node holding it must be linked.
+		map_node *findSlot(const key_type &k, map_node *&parent, bool &left) const
+		{
+			map_node *node = _root;
+			map_node *candidate = NULL;
+
+			parent = NULL;
+			left = false;
+			while (isNode(node))
+			{
+				parent = node;
+				if (_compare(k, node->value.first))
+				{
+					left = true;
 					node = node->left;
+				}
+				else
+				{
+					candidate = node;
+					left = false;
+					node = node->right;
+				}
+			}
+			if (candidate && !_compare(candidate->value.first, k))
+				return (candidate);
+			return (NULL);
+		}
+
+		//Links a new node holding val as a child of parent, or as the root when
+		//there is no parent. The child slot must be empty or hold the
+		//sentinel, which then moves below the new node.
+		map_node *insertAt(map_node *parent, bool left, const value_type &val)
+		{
+			map_node *node = createNode(val);
+
+			node->parent = parent;
+			if (!parent)
+			{
+				node->left = _begin;
+				node->right = _end;
+				_begin->parent = node;
+				_end->parent = node;
+				_root = node;
+				_size = 1;
+				return (node);
+			}
+			if (left)
+			{
+				node->left = parent->left;
+				if (node->left)
+					node->left->parent = node;
+				parent->left = node;
 			}
-			if (node && node != _end && node != _begin && !_compare(node->value.first, k) && !_compare(k, node->value.first))
-				return const_iterator(node);
 			else
-				return const_iterator(_end);
+			{
+				node->right = parent->right;
+				if (node->right)
+					node->right->parent = node;
+				parent->right = node;
+			}
+			_size++;
+			rebalance(parent);
+			return (node);
 		}
 
-		size_type count (const key_type& k) const
+		//Turns the first n nodes of a list chained through right into a perfectly
+		//balanced subtree, list is left on the node following them
+		map_node *buildSorted(map_node *&list, size_type n)
 		{
-			if (find(k) == end())
-				return (0);
-			return (1);
+			if (n == 0)
+				return (NULL);
+			map_node *left = buildSorted(list, n / 2);
+			map_node *node = list;
+			list = list->right;
+			node->left = left;
+			if (left)
+				left->parent = node;
+			node->right = buildSorted(list, n - n / 2 - 1);
+			if (node->right)
+				node->right->parent = node;
+			setHeight(node);
+			return (node);
 		}
 
-		iterator lower_bound (const key_type& k)
+		//Hangs _begin under the smallest node and _end under the biggest one
+		void wireSentinels(void)
 		{
-			key_compare compare = key_compare();
-			for (iterator i = begin(); i != end(); i++)
+			if (!_root)
 			{
-				if (!compare(i->first, k))
-					return (i);
+				_begin->parent = _end;
+				return ;
 			}
-			return (end());
+			map_node *min = _root->findMin(_root);
+			map_node *max = _root->findMax(_root);
+			min->left = _begin;
+			_begin->parent = min;
+			max->right = _end;
+			_end->parent = max;
 		}
 
-		const_iterator lower_bound (const key_type& k) const
+		void unwireSentinels(void)
 		{
-			key_compare compare = key_compare();
-			for (const_iterator i = begin(); i != end(); i++)
+			if (!_root)
+				return ;
+			_begin->parent->left = NULL;
+			_end->parent->right = NULL;
+		}
+
+		//Split and join work on subtrees whose roots have no parent and which
+		//hold no sentinel, _root is cleared while they run so that the
+		//rotations leave it alone
+
+		map_node *linkNode(map_node *node, map_node *left, map_node *right)
+		{
+			node->left = left;
+			node->right = right;
+			if (left)
+				left->parent = node;
+			if (right)
+				right->parent = node;
+			setHeight(node);
+			return (node);
+		}
+
+		//left is taller than right: node and right go down left's right spine
+		map_node *joinRight(map_node *left, map_node *node, map_node *right)
+		{
+			map_node *l = left->left;
+			map_node *c = left->right;
+
+			if (retHeight(c) <= retHeight(right) + 1)
 			{
-				if (!compare(i->first, k))
-					return (i);
+				linkNode(node, c, right);
+				linkNode(left, l, node);
+				if (retHeight(node) <= retHeight(l) + 1)
+					return (left);
+				rotateRight(node);
+				return (rotateLeft(left));
 			}
-			return (end());
+			map_node *t = joinRight(c, node, right);
+			linkNode(left, l, t);
+			if (retHeight(t) <= retHeight(l) + 1)
+				return (left);
+			return (rotateLeft(left));
 		}
 
-		iterator upper_bound (const key_type& k)
+		map_node *joinLeft(map_node *left, map_node *node, map_node *right)
 		{
-			key_compare compare = key_compare();
-			for (iterator i = begin(); i != end(); i++)
+			map_node *c = right->left;
+			map_node *r = right->right;
+
+			if (retHeight(c) <= retHeight(left) + 1)
 			{
-				if (compare(k, i->first))
-					return (i);
+				linkNode(node, left, c);
+				linkNode(right, node, r);
+				if (retHeight(node) <= retHeight(r) + 1)
+					return (right);
+				rotateLeft(node);
+				return (rotateRight(right));
 			}
-			return (end());
+			map_node *t = joinLeft(left, node, c);
+			linkNode(right, t, r);
+			if (retHeight(t) <= retHeight(r) + 1)
+				return (right);
+			return (rotateRight(right));
 		}
 
-		const_iterator upper_bound (const key_type& k) const
+		//Every key of left is smaller than node's which is smaller than every
+		//key of right, costs the height difference of the two trees
+		map_node *joinTrees(map_node *left, map_node *node, map_node *right)
+		{
+			map_node *top;
+			map_node *saved = _root;
+
+			_root = NULL;
+			if (left)
+				left->parent = NULL;
+			if (right)
+				right->parent = NULL;
+			if (retHeight(left) > retHeight(right) + 1)
+				top = joinRight(left, node, right);
+			else if (retHeight(right) > retHeight(left) + 1)
+				top = joinLeft(left, node, right);
+			else
+				top = linkNode(node, left, right);
+			top->parent = NULL;
+			_root = saved;
+			return (top);
+		}
+
+		//Same without a middle node, the last node of left takes that role
+		map_node *joinTrees(map_node *left, map_node *right)
+		{
+			map_node *last;
+
+			if (!left)
+				return (right);
+			if (!right)
+				return (left);
+			left = splitLast(left, last);
+			return (joinTrees(left, last, right));
+		}
+
+		//Removes the biggest node of the subtree into last, returns the rest
+		map_node *splitLast(map_node *root, map_node *&last)
 		{
-			key_compare compare = key_compare();
-			for (const_iterator i = begin(); i != end(); i++)
+			map_node *l = root->left;
+			map_node *r = root->right;
+
+			if (l)
+				l->parent = NULL;
+			if (!r)
 			{
-				if (compare(k, i->first))
-					return (i);
+				last = root;
+				return (l);
 			}
-			return (end());
+			r->parent = NULL;
+			map_node *rest = splitLast(r, last);
+			return (joinTrees(l, root, rest));
 		}
 
-		pair<iterator,iterator> equal_range (const key_type& k)
+		//Keys smaller than k end up in left, the others in right
+		void splitTree(map_node *root, const key_type &k, map_node *&left, map_node *&right)
 		{
-			iterator first = lower_bound(k);
-			iterator second = upper_bound(k);
-			return (make_pair(first, second));
+			if (!root)
+			{
+				left = NULL;
+				right = NULL;
+				return ;
+			}
+			map_node *l = root->left;
+			map_node *r = root->right;
+			map_node *lower;
+			map_node *upper;
+
+			if (l)
+				l->parent = NULL;
+			if (r)
+				r->parent = NULL;
+			if (!_compare(root->value.first, k))
+			{
+				splitTree(l, k, lower, upper);
+				left = lower;
+				right = joinTrees(upper, root, r);
+			}
+			else
+			{
+				splitTree(r, k, lower, upper);
+				left = joinTrees(l, root, lower);
+				right = upper;
+			}
 		}
 
-		pair<const_iterator,const_iterator> equal_range (const key_type& k) const
+		//Three way split: found gets the node with key k if there is one
+		void splitTree(map_node *root, const key_type &k, map_node *&left, map_node *&found, map_node *&right)
 		{
-			const_iterator first = lower_bound(k);
-			const_iterator second = upper_bound(k);
-			return (make_pair(first, second));
+			if (!root)
+			{
+				left = NULL;
+				found = NULL;
+				right = NULL;
+				return ;
+			}
+			map_node *l = root->left;
+			map_node *r = root->right;
+			map_node *lower;
+			map_node *upper;
+
+			if (l)
+				l->parent = NULL;
+			if (r)
+				r->parent = NULL;
+			if (_compare(k, root->value.first))
+			{
+				splitTree(l, k, left, found, upper);
+				right = joinTrees(upper, root, r);
+			}
+			else if (_compare(root->value.first, k))
+			{
+				splitTree(r, k, lower, found, right);
+				left = joinTrees(l, root, lower);
+			}
+			else
+			{
+				left = l;
+				right = r;
+				found = root;
+				root->left = NULL;
+				root->right = NULL;
+				root->parent = NULL;
+			}
 		}
 
-		map_node*	get_root(void)
+		//Detached copy of the subtree of x at src, without its sentinels
+		map_node *copyTree(map_node *src, const map &x)
 		{
-			return _root;
+			if (!x.isNode(src))
+				return (NULL);
+			map_node *node = createNode(src->value);
+			_size++;
+			linkNode(node, copyTree(src->left, x), copyTree(src->right, x));
+			return (node);
 		}
 
-		//Allocator
+		//The two recursive calls of the three functions below work on
+		//disjoint subtrees. They still run one after the other: the
+		//allocator, the size and the stats are shared.
 
-		allocator_type get_allocator(void) const
+		map_node *unionTree(map_node *root, map_node *other, const map &x)
 		{
-			allocator_type allocator_copy(_alloc);
-			return (allocator_copy);
+			map_node *left;
+			map_node *found;
+			map_node *right;
+
+			if (!x.isNode(other))
+				return (root);
+			if (!root)
+				return (copyTree(other, x));
+			splitTree(root, other->value.first, left, found, right);
+			left = unionTree(left, other->left, x);
+			right = unionTree(right, other->right, x);
+			if (!found)
+			{
+				found = createNode(other->value);
+				_size++;
+			}
+			return (joinTrees(left, found, right));
 		}
 
-		private :
+		map_node *intersectTree(map_node *root, map_node *other, const map &x)
+		{
+			map_node *left;
+			map_node *found;
+			map_node *right;
+
+			if (!root)
+				return (NULL);
+			if (!x.isNode(other))
+			{
+				_size -= releaseNodes(chainTree(root));
+				return (NULL);
+			}
+			splitTree(root, other->value.first, left, found, right);
+			left = intersectTree(left, other->left, x);
+			right = intersectTree(right, other->right, x);
+			if (found)
+				return (joinTrees(left, found, right));
+			return (joinTrees(left, right));
+		}
+
+		map_node *subtractTree(map_node *root, map_node *other, const map &x)
+		{
+			map_node *left;
+			map_node *found;
+			map_node *right;
+
+			if (!root || !x.isNode(other))
+				return (root);
+			splitTree(root, other->value.first, left, found, right);
+			left = subtractTree(left, other->left, x);
+			right = subtractTree(right, other->right, x);
+			if (found)
+			{
+				_node_alloc.destroy(found);
+				_node_alloc.deallocate(found, 1);
+				_size--;
+			}
+			return (joinTrees(left, right));
+		}
 
 		int retHeight(map_node *node)
 		{
 			if (node != NULL && node != _begin && node != _end)
-				return (node->height);
+				return (node->get_height());
 			return (-1);
 		}
 
+		//Recomputes the height and the augment of node from its children
 		void setHeight(map_node *node)
 		{
-			int left = retHeight(node->left);
-			int right = retHeight(node->right);
-			node->height = std::max(left, right) + 1;
+			map_node *left = node->left;
+			map_node *right = node->right;
+
+			node->set_height(std::max(retHeight(left), retHeight(right)) + 1);
+			augment_type::update(node, isNode(left) ? left : NULL, isNode(right) ? right : NULL);
 		}
 
 		int balanceFactor(map_node *node)
@@ -652,6 +1355,7 @@ namespace ft
 		map_node *rotateRight(map_node *node)
 		{
 			map_node *leftChild = node->left;
+			_stats.rotations++;
 			if (leftChild != NULL)
 			{
 				if (leftChild->right)
@@ -686,6 +1390,7 @@ namespace ft
 		map_node *rotateLeft(map_node *node)
 		{
 			map_node *rightChild = node->right;
+			_stats.rotations++;
 			if (rightChild != NULL)
 			{
 				if (rightChild->left)
@@ -717,24 +1422,33 @@ namespace ft
 			return (rightChild);
 		}
 
+		//Walks up from node, stops as soon as a subtree keeps the height it
+		//had before the change since nothing above it can be affected. After
+		//an insertion that happens at the latest on the first rotation, an
+		//erase may need one per level.
 		void rebalance(map_node *node)
 		{
-			if (node == NULL)
-				return ;
-			while (node->parent)
+			while (node)
 			{
+				int old = node->get_height();
+				_stats.visited++;
 				setHeight(node);
-				balance_a(node);
+				node = balance_a(node);
+				if (node->get_height() == old)
+					break ;
 				node = node->parent;
 			}
-			setHeight(node);
-			balance_a(node);
+			if (augment_type::propagates && node)
+			{
+				for (node = node->parent; node; node = node->parent)
+					setHeight(node);
+			}
 		}
 
 		map_node *balance_a(map_node *node)
 		{
 			int bf = balanceFactor(node);
-			map_node *ret;
+			map_node *ret = node;
 			if (bf < -1)
 			{
 				if (balanceFactor(node->left) <= 0)
@@ -761,11 +1475,11 @@ namespace ft
 
 	//Non-member functions
 
-	template<class Key, class T, class Compare, class Alloc>
-	bool operator==(const ft::map<Key,T,Compare,Alloc> &lhs, const ft::map<Key,T,Compare,Alloc> &rhs)
+	template<class Key, class T, class Compare, class Alloc, class Policy>
+	bool operator==(const ft::map<Key,T,Compare,Alloc,Policy> &lhs, const ft::map<Key,T,Compare,Alloc,Policy> &rhs)
 	{
-		typename ft::map<Key, T>::const_iterator rit = rhs.begin();
-		typename ft::map<Key, T>::const_iterator lit = lhs.begin();
+		typename ft::map<Key,T,Compare,Alloc,Policy>::const_iterator rit = rhs.begin();
+		typename ft::map<Key,T,Compare,Alloc,Policy>::const_iterator lit = lhs.begin();
 		if (lhs.size() != rhs.size())
 			return false;
 		while (rit != rhs.end() && lit != lhs.end())
@@ -778,38 +1492,38 @@ namespace ft
 		return true;
 	}
 
-	template<class Key, class T, class Compare, class Alloc>
-	bool operator!=(const ft::map<Key,T,Compare,Alloc> &lhs, const ft::map<Key,T,Compare,Alloc> &rhs)
+	template<class Key, class T, class Compare, class Alloc, class Policy>
+	bool operator!=(const ft::map<Key,T,Compare,Alloc,Policy> &lhs, const ft::map<Key,T,Compare,Alloc,Policy> &rhs)
 	{
 		return !(rhs == lhs);
 	}
 
-	template<class Key, class T, class Compare, class Alloc>
-	bool operator< (const ft::map<Key,T,Compare,Alloc> &lhs, const ft::map<Key,T,Compare,Alloc> &rhs)
+	template<class Key, class T, class Compare, class Alloc, class Policy>
+	bool operator< (const ft::map<Key,T,Compare,Alloc,Policy> &lhs, const ft::map<Key,T,Compare,Alloc,Policy> &rhs)
 	{
 		return (ft::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end()));
 	}
 
-	template<class Key, class T, class Compare, class Alloc>
-	bool operator<=(const ft::map<Key,T,Compare,Alloc> &lhs, const ft::map<Key,T,Compare,Alloc> &rhs)
+	template<class Key, class T, class Compare, class Alloc, class Policy>
+	bool operator<=(const ft::map<Key,T,Compare,Alloc,Policy> &lhs, const ft::map<Key,T,Compare,Alloc,Policy> &rhs)
 	{
 		return !(lhs > rhs);
 	}
 
-	template<class Key, class T, class Compare, class Alloc>
-	bool operator> (const ft::map<Key,T,Compare,Alloc> &lhs, const ft::map<Key,T,Compare,Alloc> &rhs)
+	template<class Key, class T, class Compare, class Alloc, class Policy>
+	bool operator> (const ft::map<Key,T,Compare,Alloc,Policy> &lhs, const ft::map<Key,T,Compare,Alloc,Policy> &rhs)
 	{
 		return rhs < lhs;
 	}
 
-	template<class Key, class T, class Compare, class Alloc>
-	bool operator>=(const ft::map<Key,T,Compare,Alloc> &lhs, const ft::map<Key,T,Compare,Alloc> &rhs)
+	template<class Key, class T, class Compare, class Alloc, class Policy>
+	bool operator>=(const ft::map<Key,T,Compare,Alloc,Policy> &lhs, const ft::map<Key,T,Compare,Alloc,Policy> &rhs)
 	{
 		return !(lhs < rhs);
 	}
 
-	template<class Key, class T, class Compare, class Alloc>
-	void swap(ft::map<Key,T,Compare,Alloc> &lhs, ft::map<Key,T,Compare,Alloc> &rhs)
+	template<class Key, class T, class Compare, class Alloc, class Policy>
+	void swap(ft::map<Key,T,Compare,Alloc,Policy> &lhs, ft::map<Key,T,Compare,Alloc,Policy> &rhs)
 	{
 		return lhs.swap(rhs);
 	}
@@ -0,0 +1,597 @@
+#ifndef PERSISTENT_MAP_HPP
+# define PERSISTENT_MAP_HPP
+
+#include "../iterators/utils.hpp"
+#include "../iterators/pair.hpp"
+#include "../iterators/BSTNode.hpp"
+#include "../iterators/path_iterator.hpp"
+#include "../iterators/reverse_iterator.hpp"
+
+namespace ft
+{
+	//AVL map whose copies share their nodes. A copy, or snapshot(), only
+	//takes a reference on the root, and a write copies the nodes it would
+	//change that are still referenced by another map: the path from the
+	//root to the key and the few nodes a rotation touches. Nodes only this
+	//map owns are changed in place, so a map without snapshots writes like
+	//ft::map.
+	//Nodes have no parent link, since a shared node has several, and the
+	//iterators keep their path instead. They are all const: a value shared
+	//with a snapshot must not change, operator[] copies it first.
+	//One thread writes a given map object, but snapshots can be read and
+	//dropped from other threads as long as the allocator allows it.
+	template <class Key, class T, class Compare = std::less<Key>, class Alloc = std::allocator<ft::pair<const Key,T> > >
+	class persistent_map
+	{
+		public:
+			typedef Key 														key_type;
+			typedef T 															mapped_type;
+			typedef ft::pair<const key_type,mapped_type> 						value_type;
+			typedef Compare 													key_compare;
+			typedef Alloc 														allocator_type;
+			typedef typename allocator_type::reference 							reference;
+			typedef typename allocator_type::const_reference 					const_reference;
+			typedef typename allocator_type::pointer 							pointer;
+			typedef typename allocator_type::const_pointer 						const_pointer;
+			typedef BSTNode<value_type, shared_count>							map_node;
+			typedef ft::path_iterator<map_node, const value_type>				iterator;
+			typedef iterator													const_iterator;
+			typedef ft::reverse_iterator<iterator> 								reverse_iterator;
+			typedef reverse_iterator											const_reverse_iterator;
+			typedef std::ptrdiff_t 												difference_type;
+			typedef size_t 														size_type;
+			typedef typename Alloc::template rebind<map_node>::other			node_allocator_type;
+
+		private:
+			key_compare			_compare;
+			allocator_type		_alloc;
+			node_allocator_type	_node_alloc;
+			map_node			*_root;
+			size_type			_size;
+
+		public:
+
+			class value_compare
+			{
+				friend class persistent_map;
+
+				protected:
+
+					Compare comp;
+
+					value_compare(Compare c): comp(c)
+					{
+
+					}
+
+				public:
+
+					typedef bool result_type;
+					typedef value_type first_argument_type;
+					typedef value_type second_argument_type;
+
+					bool operator()(const value_type &x, const value_type &y) const
+					{
+						return (comp(x.first, y.first));
+					}
+			};
+
+		persistent_map(const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type()): _compare(comp), _alloc(alloc), _node_alloc(alloc), _root(NULL), _size(0)
+		{
+
+		}
+
+		template <class InputIterator>
+		persistent_map(InputIterator first, InputIterator last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type()): _compare(comp), _alloc(alloc), _node_alloc(alloc), _root(NULL), _size(0)
+		{
+			insert(first, last);
+		}
+
+		//O(1): both maps share every node until one of them writes
+		persistent_map(const persistent_map &x): _compare(x._compare), _alloc(x._alloc), _node_alloc(x._node_alloc), _root(x._root), _size(x._size)
+		{
+			if (_root)
+				_root->retain();
+		}
+
+		~persistent_map()
+		{
+			releaseTree(_root);
+		}
+
+		persistent_map& operator=(const persistent_map& x)
+		{
+			if (x._root)
+				x._root->retain();
+			releaseTree(_root);
+			_root = x._root;
+			_size = x._size;
+			_compare = x._compare;
+			_alloc = x._alloc;
+			_node_alloc = x._node_alloc;
+			return (*this);
+		}
+
+		//A point in time view of the map, later writes to either side do not
+		//show in the other
+		persistent_map snapshot() const
+		{
+			return (persistent_map(*this));
+		}
+
+		//Iterators
+
+		iterator begin() const
+		{
+			iterator it(_root);
+
+			for (map_node *node = _root; node; node = node->left)
+				it.push(node);
+			return (it);
+		}
+
+		iterator end() const
+		{
+			return (iterator(_root));
+		}
+
+		reverse_iterator rbegin() const
+		{
+			return (reverse_iterator(end()));
+		}
+
+		reverse_iterator rend() const
+		{
+			return (reverse_iterator(begin()));
+		}
+
+		//Capacity
+
+		bool empty() const
+		{
+			return (_size == 0);
+		}
+
+		size_type size() const
+		{
+			return (_size);
+		}
+
+		size_type max_size() const
+		{
+			return (_node_alloc.max_size());
+		}
+
+		//Observers
+
+		key_compare key_comp() const
+		{
+			return (_compare);
+		}
+
+		value_compare value_comp() const
+		{
+			return (value_compare(_compare));
+		}
+
+		//Element access
+
+		//The reference may be written through, so the node is made ours even
+		//when the key is already there
+		mapped_type& operator[](const key_type& k)
+		{
+			map_node	*target;
+			bool		inserted = false;
+
+			_root = assoc(_root, k, NULL, target, inserted);
+			if (inserted)
+				_size++;
+			return (target->value.second);
+		}
+
+		//Modifiers
+
+		ft::pair<iterator,bool> insert(const value_type& val)
+		{
+			map_node	*target;
+			bool		inserted = false;
+
+			iterator it = find(val.first);
+			if (it != end())
+				return (ft::make_pair(it, false));
+			_root = assoc(_root, val.first, &val.second, target, inserted);
+			_size++;
+			return (ft::make_pair(find(val.first), true));
+		}
+
+		//A new node still needs the path from the root to be copied
+		iterator insert(iterator position, const value_type& val)
+		{
+			(void)position;
+			return (insert(val).first);
+		}
+
+		template <class InputIterator>
+		void insert(InputIterator first, InputIterator last)
+		{
+			for (; first != last; ++first)
+				insert(*first);
+		}
+
+		void erase(iterator position)
+		{
+			key_type k(position->first);
+
+			erase(k);
+		}
+
+		size_type erase(const key_type& k)
+		{
+			if (!count(k))
+				return (0);
+			_root = dissoc(_root, k);
+			_size--;
+			return (1);
+		}
+
+		//Every erase copies the path it changes, so the next key is looked up
+		//again
+		void erase(iterator first, iterator last)
+		{
+			if (first == begin() && last == end())
+			{
+				clear();
+				return ;
+			}
+			size_type n = 0;
+			for (iterator it = first; it != last; ++it)
+				n++;
+			while (n--)
+			{
+				key_type k(first->first);
+				erase(k);
+				if (n)
+					first = lower_bound(k);
+			}
+		}
+
+		void swap(persistent_map &x)
+		{
+			if (&x == this)
+				return ;
+			std::swap(_root, x._root);
+			std::swap(_size, x._size);
+			std::swap(_compare, x._compare);
+			std::swap(_alloc, x._alloc);
+			std::swap(_node_alloc, x._node_alloc);
+		}
+
+		void clear()
+		{
+			releaseTree(_root);
+			_root = NULL;
+			_size = 0;
+		}
+
+		//Operations
+
+		iterator find(const key_type& k) const
+		{
+			iterator it(_root);
+
+			for (map_node *node = _root; node;)
+			{
+				it.push(node);
+				if (_compare(k, node->value.first))
+					node = node->left;
+				else if (_compare(node->value.first, k))
+					node = node->right;
+				else
+					return (it);
+			}
+			return (end());
+		}
+
+		size_type count(const key_type& k) const
+		{
+			for (map_node *node = _root; node;)
+			{
+				if (_compare(k, node->value.first))
+					node = node->left;
+				else if (_compare(node->value.first, k))
+					node = node->right;
+				else
+					return (1);
+			}
+			return (0);
+		}
+
+		//The path is cut back to the last node that was a candidate
+		iterator lower_bound(const key_type& k) const
+		{
+			iterator	it(_root);
+			size_t		depth = 0;
+
+			for (map_node *node = _root; node;)
+			{
+				it.push(node);
+				if (!_compare(node->value.first, k))
+				{
+					depth = it.depth();
+					node = node->left;
+				}
+				else
+					node = node->right;
+			}
+			it.truncate(depth);
+			return (it);
+		}
+
+		iterator upper_bound(const key_type& k) const
+		{
+			iterator	it(_root);
+			size_t		depth = 0;
+
+			for (map_node *node = _root; node;)
+			{
+				it.push(node);
+				if (_compare(k, node->value.first))
+				{
+					depth = it.depth();
+					node = node->left;
+				}
+				else
+					node = node->right;
+			}
+			it.truncate(depth);
+			return (it);
+		}
+
+		ft::pair<iterator,iterator> equal_range(const key_type& k) const
+		{
+			iterator first = lower_bound(k);
+
+			if (first != end() && !_compare(k, first->first))
+			{
+				iterator last = first;
+				return (ft::make_pair(first, ++last));
+			}
+			return (ft::make_pair(first, first));
+		}
+
+		//Allocator
+
+		allocator_type get_allocator(void) const
+		{
+			allocator_type allocator_copy(_alloc);
+			return (allocator_copy);
+		}
+
+		private :
+
+		map_node *createNode(const value_type &val)
+		{
+			map_node *node = _node_alloc.allocate(1);
+
+			_node_alloc.construct(node, map_node(val));
+			return (node);
+		}
+
+		//Drops one reference, the last one frees the node and drops its
+		//references on the children
+		void releaseTree(map_node *node)
+		{
+			if (!node || !node->release())
+				return ;
+			releaseTree(node->left);
+			releaseTree(node->right);
+			_node_alloc.destroy(node);
+			_node_alloc.deallocate(node, 1);
+		}
+
+		//Returns node if this map is its only owner, otherwise a copy that
+		//shares the children. The reference the caller held on node moves to
+		//the copy.
+		map_node *own(map_node *node)
+		{
+			if (!node || !node->shared())
+				return (node);
+			map_node *copy = createNode(node->value);
+			copy->left = node->left;
+			copy->right = node->right;
+			copy->set_height(node->get_height());
+			if (copy->left)
+				copy->left->retain();
+			if (copy->right)
+				copy->right->retain();
+			releaseTree(node);
+			return (copy);
+		}
+
+		//Inserts k below node, or finds it, and returns the new root of the
+		//subtree. target is the node of k, owned by this map. val is the
+		//mapped value of a new node, NULL for a default one.
+		map_node *assoc(map_node *node, const key_type &k, const mapped_type *val, map_node *&target, bool &inserted)
+		{
+			if (!node)
+			{
+				target = createNode(value_type(k, val ? *val : mapped_type()));
+				inserted = true;
+				return (target);
+			}
+			node = own(node);
+			if (_compare(k, node->value.first))
+				node->left = assoc(node->left, k, val, target, inserted);
+			else if (_compare(node->value.first, k))
+				node->right = assoc(node->right, k, val, target, inserted);
+			else
+			{
+				target = node;
+				return (node);
+			}
+			return (balance(node));
+		}
+
+		//k must be in the subtree
+		map_node *dissoc(map_node *node, const key_type &k)
+		{
+			node = own(node);
+			if (_compare(k, node->value.first))
+				node->left = dissoc(node->left, k);
+			else if (_compare(node->value.first, k))
+				node->right = dissoc(node->right, k);
+			else
+			{
+				map_node *left = node->left;
+				map_node *right = node->right;
+				node->left = NULL;
+				node->right = NULL;
+				releaseTree(node);
+				if (!right)
+					return (left);
+				map_node *min;
+				right = removeMin(right, min);
+				min->left = left;
+				min->right = right;
+				return (balance(min));
+			}
+			return (balance(node));
+		}
+
+		//Detaches the smallest node of the subtree into min, owned and with
+		//no children
+		map_node *removeMin(map_node *node, map_node *&min)
+		{
+			node = own(node);
+			if (!node->left)
+			{
+				map_node *right = node->right;
+				node->right = NULL;
+				min = node;
+				return (right);
+			}
+			node->left = removeMin(node->left, min);
+			return (balance(node));
+		}
+
+		//node is owned, the children a rotation moves are made ours first
+		map_node *balance(map_node *node)
+		{
+			setHeight(node);
+			int bf = retHeight(node->right) - retHeight(node->left);
+			if (bf > 1)
+			{
+				map_node *right = own(node->right);
+				if (retHeight(right->left) > retHeight(right->right))
+				{
+					right->left = own(right->left);
+					right = rotateRight(right);
+				}
+				node->right = right;
+				return (rotateLeft(node));
+			}
+			if (bf < -1)
+			{
+				map_node *left = own(node->left);
+				if (retHeight(left->right) > retHeight(left->left))
+				{
+					left->right = own(left->right);
+					left = rotateLeft(left);
+				}
+				node->left = left;
+				return (rotateRight(node));
+			}
+			return (node);
+		}
+
+		map_node *rotateLeft(map_node *node)
+		{
+			map_node *right = node->right;
+
+			node->right = right->left;
+			right->left = node;
+			setHeight(node);
+			setHeight(right);
+			return (right);
+		}
+
+		map_node *rotateRight(map_node *node)
+		{
+			map_node *left = node->left;
+
+			node->left = left->right;
+			left->right = node;
+			setHeight(node);
+			setHeight(left);
+			return (left);
+		}
+
+		int retHeight(map_node *node) const
+		{
+			return (node ? node->get_height() : -1);
+		}
+
+		void setHeight(map_node *node)
+		{
+			int left = retHeight(node->left);
+			int right = retHeight(node->right);
+
+			node->set_height((left > right ? left : right) + 1);
+		}
+	};
+
+	template<class Key, class T, class Compare, class Alloc>
+	bool operator==(const ft::persistent_map<Key,T,Compare,Alloc> &lhs, const ft::persistent_map<Key,T,Compare,Alloc> &rhs)
+	{
+		typename ft::persistent_map<Key,T,Compare,Alloc>::const_iterator rit = rhs.begin();
+		typename ft::persistent_map<Key,T,Compare,Alloc>::const_iterator lit = lhs.begin();
+		if (lhs.size() != rhs.size())
+			return false;
+		while (rit != rhs.end() && lit != lhs.end())
+		{
+			if (*rit != *lit)
+				return false;
+			rit++;
+			lit++;
+		}
+		return true;
+	}
+
+	template<class Key, class T, class Compare, class Alloc>
+	bool operator!=(const ft::persistent_map<Key,T,Compare,Alloc> &lhs, const ft::persistent_map<Key,T,Compare,Alloc> &rhs)
+	{
+		return !(rhs == lhs);
+	}
+
+	template<class Key, class T, class Compare, class Alloc>
+	bool operator< (const ft::persistent_map<Key,T,Compare,Alloc> &lhs, const ft::persistent_map<Key,T,Compare,Alloc> &rhs)
+	{
+		return (ft::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end()));
+	}
+
+	template<class Key, class T, class Compare, class Alloc>
+	bool operator<=(const ft::persistent_map<Key,T,Compare,Alloc> &lhs, const ft::persistent_map<Key,T,Compare,Alloc> &rhs)
+	{
+		return !(lhs > rhs);
+	}
+
+	template<class Key, class T, class Compare, class Alloc>
+	bool operator> (const ft::persistent_map<Key,T,Compare,Alloc> &lhs, const ft::persistent_map<Key,T,Compare,Alloc> &rhs)
+	{
+		return rhs < lhs;
+	}
+
+	template<class Key, class T, class Compare, class Alloc>
+	bool operator>=(const ft::persistent_map<Key,T,Compare,Alloc> &lhs, const ft::persistent_map<Key,T,Compare,Alloc> &rhs)
+	{
+		return !(lhs < rhs);
+	}
+
+	template<class Key, class T, class Compare, class Alloc>
+	void swap(ft::persistent_map<Key,T,Compare,Alloc> &lhs, ft::persistent_map<Key,T,Compare,Alloc> &rhs)
+	{
+		return lhs.swap(rhs);
+	}
+}
+
+#endif
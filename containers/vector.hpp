@@ -72,7 +72,7 @@ namespace ft
 						_alloc.construct(_i + _size, *(first++));
 				}
 
-				explicit vector(const ft::vector<value_type> & copy): _size(0), _capacity(copy._capacity), _alloc(copy._alloc) {
+				explicit vector(const vector & copy): _size(0), _capacity(copy._capacity), _alloc(copy._alloc) {
 					this->_i = this->_alloc.allocate(this->_capacity);
 					for (size_type i = 0; i < copy._size; i++, _size++)
 					{
@@ -392,10 +392,10 @@ namespace ft
 					size_type index_first = ft::distance(begin(), first);
 					size_type index_last = ft::distance(begin(), last);
 					size_type n = index_last - index_first;
-					for (size_type i = index_first; i < index_last; ++i)
+					for (size_type i = index_first; i + n < _size; ++i)
+						_i[i] = _i[i + n];
+					for (size_type i = _size - n; i < _size; ++i)
 						_alloc.destroy(_i + i);
-					for (size_type i = index_last; i < _size; ++i)
-						_alloc.construct(_i + (i - n), *(_i + i));
 					_size -= n;
 					return first;
 				}
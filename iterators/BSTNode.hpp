@@ -2,34 +2,235 @@
 #define BSTNODE_HPP
 
 #include "pair.hpp"
+#include <cstddef>
 
 namespace ft
 {
-	template<class Pair>
-	struct BSTNode
+	//Augments are mixed into the nodes. update() recomputes the node's data
+	//from its children, which are NULL when missing or when they are a
+	//sentinel. propagates tells whether a change must be carried up to the
+	//root even once the heights stop changing.
+
+	struct no_augment
 	{
-		BSTNode* parent;
-		BSTNode* left;
-		BSTNode* right;
-		Pair value;
+		static const bool propagates = false;
+
+		template <class Node>
+		static void update(Node *, const Node *, const Node *)
+		{
+
+		}
+	};
+
+	//Number of nodes in the subtree, for order statistics
+	struct subtree_size
+	{
+		static const bool propagates = true;
+
+		size_t size;
+
+		subtree_size(): size(1)
+		{
+
+		}
+
+		template <class Node>
+		static void update(Node *node, const Node *left, const Node *right)
+		{
+			node->size = 1 + (left ? left->size : 0) + (right ? right->size : 0);
+		}
+	};
+
+	//Number of owners of a node, for trees that share subtrees. A copy of a
+	//node starts with a single owner. The count is atomic so that a tree
+	//and its snapshots can be dropped from different threads.
+	struct shared_count
+	{
+		static const bool propagates = false;
+
+		size_t refs;
+
+		shared_count(): refs(1)
+		{
+
+		}
+
+		shared_count(const shared_count &): refs(1)
+		{
+
+		}
+
+		void retain(void)
+		{
+			__sync_add_and_fetch(&refs, 1);
+		}
+
+		//True when the last owner is gone
+		bool release(void)
+		{
+			return (__sync_sub_and_fetch(&refs, 1) == 0);
+		}
+
+		bool shared(void) const
+		{
+			return (__atomic_load_n(&refs, __ATOMIC_ACQUIRE) > 1);
+		}
+
+		template <class Node>
+		static void update(Node *, const Node *, const Node *)
+		{
+
+		}
+	};
+
+	//Link to a node whose low bits, always clear since nodes are aligned on
+	//the size of a pointer, carry a few bits of the node owning the link.
+	//Assigning a node only replaces the address and keeps the tag.
+	template <class Node>
+	class tagged_ptr
+	{
+		public:
+
+			static const size_t bits = sizeof(void *) == 8 ? 3 : 2;
+			static const size_t mask = (size_t(1) << bits) - 1;
+
+		private:
+
+			size_t	_bits;
+
+		public:
+
+			tagged_ptr(): _bits(0)
+			{
+
+			}
+
+			tagged_ptr(Node *node): _bits(reinterpret_cast<size_t>(node))
+			{
+
+			}
+
+			tagged_ptr(const tagged_ptr &x): _bits(x._bits)
+			{
+
+			}
+
+			tagged_ptr &operator=(const tagged_ptr &x)
+			{
+				_bits = (_bits & mask) | (x._bits & ~mask);
+				return (*this);
+			}
+
+			tagged_ptr &operator=(Node *node)
+			{
+				_bits = (_bits & mask) | reinterpret_cast<size_t>(node);
+				return (*this);
+			}
+
+			operator Node*() const
+			{
+				return (reinterpret_cast<Node *>(_bits & ~mask));
+			}
+
+			Node *operator->() const
+			{
+				return (reinterpret_cast<Node *>(_bits & ~mask));
+			}
+
+			size_t tag() const
+			{
+				return (_bits & mask);
+			}
+
+			void set_tag(size_t tag)
+			{
+				_bits = (_bits & ~mask) | (tag & mask);
+			}
+	};
+
+	//Where a node keeps its links and its height. The plain layout uses raw
+	//pointers and an int, the compact one spreads the height over the tags
+	//of its three links, which leaves room for heights up to 511 (63 on 32
+	//bits), far above what an AVL tree of any size can reach.
+	template <bool Compact>
+	struct node_layout
+	{
+		template <class Node>
+		struct link
+		{
+			typedef Node *type;
+		};
+
 		int height;
 
-		BSTNode(): parent(NULL), left(NULL), right(NULL), value(), height(0)
+		node_layout(): height(0)
 		{
 
 		}
 
-		BSTNode(const Pair &data): parent(NULL), left(NULL), right(NULL), value(data), height(0)
+		template <class Node>
+		static int get_height(const Node &node)
 		{
+			return (node.height);
+		}
 
+		template <class Node>
+		static void set_height(Node &node, int height)
+		{
+			node.height = height;
 		}
+	};
 
-		// BSTNode(BSTNode *parent, BSTNode *left, BSTNode *right): parent(parent), left(left), right(right), value(), height(0)
-		// {
+	template <>
+	struct node_layout<true>
+	{
+		template <class Node>
+		struct link
+		{
+			typedef tagged_ptr<Node> type;
+		};
+
+		template <class Node>
+		static int get_height(const Node &node)
+		{
+			const size_t bits = tagged_ptr<Node>::bits;
+
+			return (static_cast<int>(node.left.tag() | node.right.tag() << bits | node.parent.tag() << 2 * bits));
+		}
+
+		template <class Node>
+		static void set_height(Node &node, int height)
+		{
+			const size_t bits = tagged_ptr<Node>::bits;
+
+			node.left.set_tag(height);
+			node.right.set_tag(height >> bits);
+			node.parent.set_tag(height >> 2 * bits);
+		}
+	};
+
+	template<class Pair, class Augment = no_augment, bool Compact = false>
+	struct BSTNode : public Augment, public node_layout<Compact>
+	{
+		typedef node_layout<Compact>								layout_type;
+		typedef typename layout_type::template link<BSTNode>::type	link_type;
+
+		link_type parent;
+		link_type left;
+		link_type right;
+		Pair value;
+
+		BSTNode(): parent(NULL), left(NULL), right(NULL), value()
+		{
+
+		}
+
+		BSTNode(const Pair &data): parent(NULL), left(NULL), right(NULL), value(data)
+		{
 
-		// }
+		}
 
-		BSTNode(const BSTNode &x): parent(x.parent), left(x.left), right(x.right), value(x.value), height(x.height)
+		BSTNode(const BSTNode &x): Augment(x), layout_type(x), parent(x.parent), left(x.left), right(x.right), value(x.value)
 		{
 
 		}
@@ -51,6 +252,16 @@ namespace ft
 			return (*this);
 		}
 
+		int get_height() const
+		{
+			return (layout_type::get_height(*this));
+		}
+
+		void set_height(int height)
+		{
+			layout_type::set_height(*this, height);
+		}
+
 		BSTNode *findMin(BSTNode *node)
 		{
 			if (!node)
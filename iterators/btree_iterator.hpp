@@ -0,0 +1,241 @@
+#ifndef BTREE_ITERATOR_HPP
+#define BTREE_ITERATOR_HPP
+
+#include <cstddef>
+#include <iterator>
+#include "btree_node.hpp"
+
+namespace ft
+{
+	//A position is a leaf and an index in it. end() is one past the last
+	//value of the last leaf, so stepping off a leaf only moves to the next
+	//one when there is one.
+	template <class Leaf, class T>
+	class btree_iterator
+	{
+		public:
+
+			typedef T									value_type;
+			typedef std::ptrdiff_t						difference_type;
+			typedef T*									pointer;
+			typedef T&									reference;
+			typedef std::bidirectional_iterator_tag		iterator_category;
+
+		protected:
+
+			Leaf	*_leaf;
+			size_t	_pos;
+
+		public:
+
+			btree_iterator(): _leaf(NULL), _pos(0)
+			{
+
+			}
+
+			btree_iterator(const btree_iterator &x): _leaf(x._leaf), _pos(x._pos)
+			{
+
+			}
+
+			btree_iterator(Leaf *leaf, size_t pos): _leaf(leaf), _pos(pos)
+			{
+
+			}
+
+			~btree_iterator()
+			{
+
+			}
+
+			Leaf *get_leaf(void) const
+			{
+				return (_leaf);
+			}
+
+			size_t get_pos(void) const
+			{
+				return (_pos);
+			}
+
+			btree_iterator &operator=(const btree_iterator &x)
+			{
+				_leaf = x._leaf;
+				_pos = x._pos;
+				return (*this);
+			}
+
+			bool operator==(const btree_iterator &x) const
+			{
+				return (_leaf == x._leaf && _pos == x._pos);
+			}
+
+			bool operator!=(const btree_iterator &x) const
+			{
+				return (!(*this == x));
+			}
+
+			reference operator*() const
+			{
+				return (_leaf->values()[_pos]);
+			}
+
+			pointer operator->() const
+			{
+				return (&_leaf->values()[_pos]);
+			}
+
+			btree_iterator &operator++()
+			{
+				if (++_pos == _leaf->count && _leaf->next)
+				{
+					_leaf = _leaf->next;
+					_pos = 0;
+				}
+				return (*this);
+			}
+
+			btree_iterator operator++(int)
+			{
+				btree_iterator tmp(*this);
+				++*this;
+				return (tmp);
+			}
+
+			btree_iterator &operator--()
+			{
+				if (_pos == 0)
+				{
+					_leaf = _leaf->prev;
+					_pos = _leaf->count;
+				}
+				_pos--;
+				return (*this);
+			}
+
+			btree_iterator operator--(int)
+			{
+				btree_iterator tmp(*this);
+				--*this;
+				return (tmp);
+			}
+	};
+
+	template <class Leaf, class T, class btree_iterator>
+	class const_btree_iterator
+	{
+		public:
+
+			typedef T									value_type;
+			typedef std::ptrdiff_t						difference_type;
+			typedef T*									pointer;
+			typedef T&									reference;
+			typedef std::bidirectional_iterator_tag		iterator_category;
+
+		protected:
+
+			Leaf	*_leaf;
+			size_t	_pos;
+
+		public:
+
+			const_btree_iterator(): _leaf(NULL), _pos(0)
+			{
+
+			}
+
+			const_btree_iterator(const const_btree_iterator &x): _leaf(x._leaf), _pos(x._pos)
+			{
+
+			}
+
+			const_btree_iterator(Leaf *leaf, size_t pos): _leaf(leaf), _pos(pos)
+			{
+
+			}
+
+			const_btree_iterator(const btree_iterator &other): _leaf(other.get_leaf()), _pos(other.get_pos())
+			{
+
+			}
+
+			~const_btree_iterator()
+			{
+
+			}
+
+			Leaf *get_leaf(void) const
+			{
+				return (_leaf);
+			}
+
+			size_t get_pos(void) const
+			{
+				return (_pos);
+			}
+
+			const_btree_iterator &operator=(const const_btree_iterator &x)
+			{
+				_leaf = x._leaf;
+				_pos = x._pos;
+				return (*this);
+			}
+
+			bool operator==(const const_btree_iterator &x) const
+			{
+				return (_leaf == x._leaf && _pos == x._pos);
+			}
+
+			bool operator!=(const const_btree_iterator &x) const
+			{
+				return (!(*this == x));
+			}
+
+			reference operator*() const
+			{
+				return (_leaf->values()[_pos]);
+			}
+
+			pointer operator->() const
+			{
+				return (&_leaf->values()[_pos]);
+			}
+
+			const_btree_iterator &operator++()
+			{
+				if (++_pos == _leaf->count && _leaf->next)
+				{
+					_leaf = _leaf->next;
+					_pos = 0;
+				}
+				return (*this);
+			}
+
+			const_btree_iterator operator++(int)
+			{
+				const_btree_iterator tmp(*this);
+				++*this;
+				return (tmp);
+			}
+
+			const_btree_iterator &operator--()
+			{
+				if (_pos == 0)
+				{
+					_leaf = _leaf->prev;
+					_pos = _leaf->count;
+				}
+				_pos--;
+				return (*this);
+			}
+
+			const_btree_iterator operator--(int)
+			{
+				const_btree_iterator tmp(*this);
+				--*this;
+				return (tmp);
+			}
+	};
+}
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef BTREE_NODE_HPP
+#define BTREE_NODE_HPP
+
+#include <cstddef>
+
+namespace ft
+{
+	//Room for Capacity objects of type T. The tree constructs and destroys
+	//them itself so that a node never builds the slots it does not use.
+	template <class T, size_t Capacity>
+	union btree_storage
+	{
+		char		raw[Capacity * sizeof(T)];
+		double		align_double;
+		long long	align_long;
+		void		*align_ptr;
+	};
+
+	struct btree_node
+	{
+		unsigned int	count;
+		bool			leaf;
+	};
+
+	//Leaves hold the values, sorted, and are chained in order so that the
+	//iterators never climb back into the tree
+	template <class Value, size_t Capacity>
+	struct btree_leaf : public btree_node
+	{
+		btree_leaf						*prev;
+		btree_leaf						*next;
+		btree_storage<Value, Capacity>	storage;
+
+		Value *values()
+		{
+			return (reinterpret_cast<Value *>(storage.raw));
+		}
+
+		const Value *values() const
+		{
+			return (reinterpret_cast<const Value *>(storage.raw));
+		}
+	};
+
+	//count keys split count + 1 children: children[i] holds the keys k with
+	//keys[i - 1] <= k < keys[i]
+	template <class Key, size_t Capacity>
+	struct btree_inner : public btree_node
+	{
+		btree_node						*children[Capacity + 1];
+		btree_storage<Key, Capacity>	storage;
+
+		Key *keys()
+		{
+			return (reinterpret_cast<Key *>(storage.raw));
+		}
+
+		const Key *keys() const
+		{
+			return (reinterpret_cast<const Key *>(storage.raw));
+		}
+	};
+}
+
+#endif
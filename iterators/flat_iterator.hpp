@@ -0,0 +1,178 @@
+#ifndef FLAT_ITERATOR_HPP
+#define FLAT_ITERATOR_HPP
+
+#include <cstddef>
+#include <iterator>
+
+namespace ft
+{
+	//operator-> for iterators whose reference is a proxy returned by value
+	template <class Reference>
+	struct flat_arrow
+	{
+		Reference	ref;
+
+		flat_arrow(const Reference &r): ref(r)
+		{
+
+		}
+
+		Reference *operator->()
+		{
+			return (&ref);
+		}
+	};
+
+	//Index into the storage of a flat container. The storage gives the
+	//reference and the pointer of a slot, so the same iterator walks a
+	//vector of pairs or separate key and value vectors.
+	template <class Storage, class Value, class Reference, class Pointer>
+	class flat_iterator
+	{
+		public:
+
+			typedef Value								value_type;
+			typedef std::ptrdiff_t						difference_type;
+			typedef Pointer								pointer;
+			typedef Reference							reference;
+			typedef std::random_access_iterator_tag		iterator_category;
+
+		private:
+
+			Storage	*_storage;
+			size_t	_pos;
+
+		public:
+
+			flat_iterator(): _storage(NULL), _pos(0)
+			{
+
+			}
+
+			flat_iterator(Storage *storage, size_t pos): _storage(storage), _pos(pos)
+			{
+
+			}
+
+			template <class S, class R, class P>
+			flat_iterator(const flat_iterator<S, Value, R, P> &other): _storage(other.get_storage()), _pos(other.get_pos())
+			{
+
+			}
+
+			~flat_iterator()
+			{
+
+			}
+
+			Storage *get_storage(void) const
+			{
+				return (_storage);
+			}
+
+			size_t get_pos(void) const
+			{
+				return (_pos);
+			}
+
+			reference operator*() const
+			{
+				return (_storage->ref(_pos));
+			}
+
+			pointer operator->() const
+			{
+				return (_storage->ptr(_pos));
+			}
+
+			reference operator[](difference_type n) const
+			{
+				return (_storage->ref(_pos + n));
+			}
+
+			flat_iterator &operator++()
+			{
+				_pos++;
+				return (*this);
+			}
+
+			flat_iterator operator++(int)
+			{
+				flat_iterator tmp(*this);
+				_pos++;
+				return (tmp);
+			}
+
+			flat_iterator &operator--()
+			{
+				_pos--;
+				return (*this);
+			}
+
+			flat_iterator operator--(int)
+			{
+				flat_iterator tmp(*this);
+				_pos--;
+				return (tmp);
+			}
+
+			flat_iterator &operator+=(difference_type n)
+			{
+				_pos += n;
+				return (*this);
+			}
+
+			flat_iterator &operator-=(difference_type n)
+			{
+				_pos -= n;
+				return (*this);
+			}
+
+			flat_iterator operator+(difference_type n) const
+			{
+				return (flat_iterator(_storage, _pos + n));
+			}
+
+			flat_iterator operator-(difference_type n) const
+			{
+				return (flat_iterator(_storage, _pos - n));
+			}
+
+			difference_type operator-(const flat_iterator &x) const
+			{
+				return (static_cast<difference_type>(_pos) - static_cast<difference_type>(x._pos));
+			}
+
+			bool operator==(const flat_iterator &x) const
+			{
+				return (_pos == x._pos && _storage == x._storage);
+			}
+
+			bool operator!=(const flat_iterator &x) const
+			{
+				return (!(*this == x));
+			}
+
+			bool operator<(const flat_iterator &x) const
+			{
+				return (_pos < x._pos);
+			}
+
+			bool operator>(const flat_iterator &x) const
+			{
+				return (_pos > x._pos);
+			}
+
+			bool operator<=(const flat_iterator &x) const
+			{
+				return (_pos <= x._pos);
+			}
+
+			bool operator>=(const flat_iterator &x) const
+			{
+				return (_pos >= x._pos);
+			}
+	};
+}
+
+#endif
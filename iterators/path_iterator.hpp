@@ -0,0 +1,167 @@
+#ifndef PATH_ITERATOR_HPP
+#define PATH_ITERATOR_HPP
+
+#include <cstddef>
+#include <iterator>
+
+namespace ft
+{
+	//Iterator for trees whose nodes have no parent link, because they are
+	//shared between several trees. It keeps the path from the root to the
+	//current node, an empty path is end(). 64 levels hold any AVL tree that
+	//fits in memory.
+	template <class Node, class T>
+	class path_iterator
+	{
+		public:
+
+			typedef T									value_type;
+			typedef std::ptrdiff_t						difference_type;
+			typedef T*									pointer;
+			typedef T&									reference;
+			typedef std::bidirectional_iterator_tag		iterator_category;
+
+			static const size_t	max_depth = 64;
+
+		private:
+
+			Node	*_root;
+			Node	*_path[max_depth];
+			size_t	_depth;
+
+			void pushLeftmost(Node *node)
+			{
+				for (; node; node = node->left)
+					_path[_depth++] = node;
+			}
+
+			void pushRightmost(Node *node)
+			{
+				for (; node; node = node->right)
+					_path[_depth++] = node;
+			}
+
+		public:
+
+			path_iterator(): _root(NULL), _depth(0)
+			{
+
+			}
+
+			path_iterator(Node *root): _root(root), _depth(0)
+			{
+
+			}
+
+			path_iterator(const path_iterator &x): _root(x._root), _depth(x._depth)
+			{
+				for (size_t i = 0; i < _depth; i++)
+					_path[i] = x._path[i];
+			}
+
+			~path_iterator()
+			{
+
+			}
+
+			path_iterator &operator=(const path_iterator &x)
+			{
+				_root = x._root;
+				_depth = x._depth;
+				for (size_t i = 0; i < _depth; i++)
+					_path[i] = x._path[i];
+				return (*this);
+			}
+
+			//For the container, which builds the path while it descends
+			void push(Node *node)
+			{
+				_path[_depth++] = node;
+			}
+
+			void truncate(size_t depth)
+			{
+				_depth = depth;
+			}
+
+			size_t depth(void) const
+			{
+				return (_depth);
+			}
+
+			Node *get_internal_pointer(void) const
+			{
+				return (_depth ? _path[_depth - 1] : NULL);
+			}
+
+			bool operator==(const path_iterator &x) const
+			{
+				return (get_internal_pointer() == x.get_internal_pointer());
+			}
+
+			bool operator!=(const path_iterator &x) const
+			{
+				return (get_internal_pointer() != x.get_internal_pointer());
+			}
+
+			reference operator*() const
+			{
+				return (_path[_depth - 1]->value);
+			}
+
+			pointer operator->() const
+			{
+				return (&_path[_depth - 1]->value);
+			}
+
+			path_iterator &operator++()
+			{
+				Node *child = _path[_depth - 1];
+
+				if (child->right)
+					pushLeftmost(child->right);
+				else
+				{
+					_depth--;
+					while (_depth && _path[_depth - 1]->right == child)
+						child = _path[--_depth];
+				}
+				return (*this);
+			}
+
+			path_iterator operator++(int)
+			{
+				path_iterator tmp(*this);
+				++*this;
+				return (tmp);
+			}
+
+			path_iterator &operator--()
+			{
+				if (!_depth)
+				{
+					pushRightmost(_root);
+					return (*this);
+				}
+				Node *child = _path[_depth - 1];
+				if (child->left)
+					pushRightmost(child->left);
+				else
+				{
+					_depth--;
+					while (_depth && _path[_depth - 1]->left == child)
+						child = _path[--_depth];
+				}
+				return (*this);
+			}
+
+			path_iterator operator--(int)
+			{
+				path_iterator tmp(*this);
+				--*this;
+				return (tmp);
+			}
+	};
+}
+
+#endif
@@ -0,0 +1,320 @@
+#ifndef POOL_ALLOCATOR_HPP
+#define POOL_ALLOCATOR_HPP
+
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include <limits>
+#include <sys/mman.h>
+
+namespace ft
+{
+	//Carves fixed size nodes out of slabs. Every slab is aligned on its own
+	//size, so a node finds the header of its slab by masking its address.
+	//Freed nodes go on an intrusive free list, the slab header only counts
+	//the nodes still in use so that trim() can give empty slabs back.
+	class node_pool
+	{
+		private:
+
+			struct free_node
+			{
+				free_node	*next;
+			};
+
+			struct slab
+			{
+				slab	*next;
+				size_t	live;
+			};
+
+			size_t		_node_size;
+			size_t		_header_size;
+			size_t		_slab_size;
+			bool		_huge_pages;
+			slab		*_slabs;
+			free_node	*_free;
+			char		*_cursor;
+			char		*_limit;
+			size_t		_refs;
+
+			node_pool(const node_pool &);
+			node_pool &operator=(const node_pool &);
+
+			static size_t round_up(size_t n, size_t align)
+			{
+				return ((n + align - 1) / align * align);
+			}
+
+			slab *slab_of(void *p) const
+			{
+				return (reinterpret_cast<slab *>(reinterpret_cast<size_t>(p) & ~(_slab_size - 1)));
+			}
+
+			void new_slab(void)
+			{
+				void *mem = NULL;
+
+				if (posix_memalign(&mem, _slab_size, _slab_size))
+					throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+				if (_huge_pages)
+					madvise(mem, _slab_size, MADV_HUGEPAGE);
+#endif
+				slab *s = static_cast<slab *>(mem);
+				s->next = _slabs;
+				s->live = 0;
+				_slabs = s;
+				_cursor = static_cast<char *>(mem) + _header_size;
+				_limit = static_cast<char *>(mem) + _slab_size;
+			}
+
+		public:
+
+			node_pool(size_t node_size, size_t align, size_t slab_size, bool huge_pages): _slab_size(slab_size), _huge_pages(huge_pages), _slabs(NULL), _free(NULL), _cursor(NULL), _limit(NULL), _refs(1)
+			{
+				if (align < sizeof(void *))
+					align = sizeof(void *);
+				_node_size = round_up(node_size < sizeof(free_node) ? sizeof(free_node) : node_size, align);
+				_header_size = round_up(sizeof(slab), align);
+			}
+
+			~node_pool()
+			{
+				while (_slabs)
+				{
+					slab *next = _slabs->next;
+					free(_slabs);
+					_slabs = next;
+				}
+			}
+
+			void retain(void)
+			{
+				_refs++;
+			}
+
+			void release(void)
+			{
+				if (--_refs == 0)
+					delete this;
+			}
+
+			void *allocate(void)
+			{
+				void *p;
+
+				if (_free)
+				{
+					p = _free;
+					_free = _free->next;
+				}
+				else
+				{
+					if (_cursor + _node_size > _limit)
+						new_slab();
+					p = _cursor;
+					_cursor += _node_size;
+				}
+				slab_of(p)->live++;
+				return (p);
+			}
+
+			void deallocate(void *p)
+			{
+				free_node *node = static_cast<free_node *>(p);
+
+				node->next = _free;
+				_free = node;
+				slab_of(p)->live--;
+			}
+
+			//Releases every slab that has no node in use, returns how many were released
+			size_t trim(void)
+			{
+				size_t released = 0;
+				slab **s;
+
+				for (s = &_slabs; *s; s = &(*s)->next)
+					if ((*s)->live == 0)
+						break ;
+				if (!*s)
+					return (0);
+				free_node **node = &_free;
+				while (*node)
+				{
+					if (slab_of(*node)->live == 0)
+						*node = (*node)->next;
+					else
+						node = &(*node)->next;
+				}
+				if (_cursor && slab_of(_cursor - 1)->live == 0)
+				{
+					_cursor = NULL;
+					_limit = NULL;
+				}
+				s = &_slabs;
+				while (*s)
+				{
+					if ((*s)->live == 0)
+					{
+						slab *empty = *s;
+						*s = empty->next;
+						free(empty);
+						released++;
+					}
+					else
+						s = &(*s)->next;
+				}
+				return (released);
+			}
+	};
+
+	//Single node allocations come from a node_pool shared by all the copies
+	//of the allocator, anything bigger goes to operator new. Rebinding to
+	//another type starts a new pool since the node size changes.
+	template <class T, size_t SlabSize = 65536, bool HugePages = false>
+	class pool_allocator
+	{
+		public:
+
+			typedef T			value_type;
+			typedef T*			pointer;
+			typedef const T*	const_pointer;
+			typedef T&			reference;
+			typedef const T&	const_reference;
+			typedef size_t		size_type;
+			typedef ptrdiff_t	difference_type;
+
+			template <class U>
+			struct rebind
+			{
+				typedef pool_allocator<U, SlabSize, HugePages> other;
+			};
+
+		private:
+
+			template <class U, size_t S, bool H> friend class pool_allocator;
+
+			node_pool	*_pool;
+
+			node_pool *pool(void)
+			{
+				if (!_pool)
+					_pool = new node_pool(sizeof(T), __alignof__(T), SlabSize, HugePages);
+				return (_pool);
+			}
+
+		public:
+
+			pool_allocator(): _pool(NULL)
+			{
+
+			}
+
+			pool_allocator(const pool_allocator &x): _pool(x._pool)
+			{
+				if (_pool)
+					_pool->retain();
+			}
+
+			template <class U>
+			pool_allocator(const pool_allocator<U, SlabSize, HugePages> &): _pool(NULL)
+			{
+
+			}
+
+			~pool_allocator()
+			{
+				if (_pool)
+					_pool->release();
+			}
+
+			pool_allocator &operator=(const pool_allocator &x)
+			{
+				if (_pool != x._pool)
+				{
+					if (x._pool)
+						x._pool->retain();
+					if (_pool)
+						_pool->release();
+					_pool = x._pool;
+				}
+				return (*this);
+			}
+
+			pointer address(reference x) const
+			{
+				return (&x);
+			}
+
+			const_pointer address(const_reference x) const
+			{
+				return (&x);
+			}
+
+			pointer allocate(size_type n, const void * = 0)
+			{
+				if (n != 1)
+					return (static_cast<pointer>(::operator new(n * sizeof(T))));
+				return (static_cast<pointer>(pool()->allocate()));
+			}
+
+			void deallocate(pointer p, size_type n)
+			{
+				if (n != 1)
+					::operator delete(p);
+				else
+					_pool->deallocate(p);
+			}
+
+			size_type max_size() const
+			{
+				return (std::numeric_limits<size_type>::max() / sizeof(T));
+			}
+
+			void construct(pointer p, const_reference val)
+			{
+				new (p) T(val);
+			}
+
+			void destroy(pointer p)
+			{
+				p->~T();
+			}
+
+			size_type trim(void)
+			{
+				if (!_pool)
+					return (0);
+				return (_pool->trim());
+			}
+
+			template <class U>
+			bool operator==(const pool_allocator<U, SlabSize, HugePages> &x) const
+			{
+				return (_pool == x._pool);
+			}
+
+			template <class U>
+			bool operator!=(const pool_allocator<U, SlabSize, HugePages> &x) const
+			{
+				return (_pool != x._pool);
+			}
+	};
+
+	//Lets containers call trim() whatever their allocator is
+	template <class Alloc>
+	size_t pool_trim(Alloc &)
+	{
+		return (0);
+	}
+
+	template <class T, size_t SlabSize, bool HugePages>
+	size_t pool_trim(pool_allocator<T, SlabSize, HugePages> &alloc)
+	{
+		return (alloc.trim());
+	}
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include "iterator_traits.hpp"
 #include <algorithm>
 #include <iostream>
+#include <limits>
 
 namespace ft {
 
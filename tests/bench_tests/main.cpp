@@ -0,0 +1,863 @@
+#include "../../containers/map.hpp"
+#include "../../containers/btree_map.hpp"
+#include "../../containers/flat_map.hpp"
+
+#include <map>
+#include <vector>
+#include <iostream>
+#include <string>
+#include <limits>
+#include <sys/time.h>
+#include <stdlib.h>
+
+#define QUERIES 200000
+#define CHURN_SIZE 100000
+#define CHURN_ROUNDS 1000000
+#define INGEST_SIZE 100000
+#define LOAD_SIZE 10000000
+#define COPY_SIZE 100000
+#define COPY_ROUNDS 10
+#define TEARDOWN_SIZE 1000000
+#define INSERT_SIZE 1000000
+#define REBALANCE_SIZE 1000000
+#define ORDER_SIZE 1000000
+#define ORDER_STD_QUERIES 20
+#define LAYOUT_SIZE 4000000
+#define BTREE_SIZE 4000000
+#define FLAT_SIZE 4000000
+#define SPLIT_SIZE 1000000
+#define SPLIT_ROUNDS 1000
+#define SPLIT_STD_ROUNDS 5
+#define SETOP_BIG 10000000
+#define SETOP_SMALL 1000
+#define SETOP_ROUNDS 100
+#define SETOP_EVEN 1000000
+
+long int	ft_get_time(void)
+{
+	struct timeval	t;
+
+	gettimeofday(&t, NULL);
+	return ((t.tv_sec * 1000000) + (t.tv_usec));
+}
+
+void print_bench(std::string name, size_t n, long int start, long int end, size_t ops)
+{
+	std::cout << "Bench " << name << " n=" << n << " takes [" << ((float)(end - start)) << "] usec";
+	if (ops)
+		std::cout << " (" << ((float)(end - start)) * 1000 / ops << " ns/op)";
+	std::cout << std::endl;
+}
+
+void check(std::string name, long ft_sum, long std_sum)
+{
+	if (ft_sum != std_sum)
+		std::cout << "KO " << name << ": ft [" << ft_sum << "] std [" << std_sum << "]" << std::endl;
+}
+
+//Bounds
+
+template <typename MAP>
+long bench_bounds_on(MAP &mp, std::string name, size_t n, int *keys)
+{
+	long sum = 0;
+	long int start;
+
+	start = ft_get_time();
+	for (size_t i = 0; i < QUERIES; i++)
+	{
+		typename MAP::iterator it = mp.lower_bound(keys[i]);
+		if (it != mp.end())
+			sum += it->first;
+	}
+	print_bench(name + " lower_bound", n, start, ft_get_time(), QUERIES);
+	start = ft_get_time();
+	for (size_t i = 0; i < QUERIES; i++)
+	{
+		typename MAP::iterator it = mp.upper_bound(keys[i]);
+		if (it != mp.end())
+			sum += it->first;
+	}
+	print_bench(name + " upper_bound", n, start, ft_get_time(), QUERIES);
+	start = ft_get_time();
+	for (size_t i = 0; i < QUERIES; i++)
+	{
+		typename MAP::iterator it = mp.equal_range(keys[i]).second;
+		if (it != mp.end())
+			sum += it->first;
+	}
+	print_bench(name + " equal_range", n, start, ft_get_time(), QUERIES);
+	return (sum);
+}
+
+void bench_bounds()
+{
+	int *keys = new int[QUERIES];
+
+	for (size_t n = 1000; n <= 1000000; n *= 10)
+	{
+		ft::map<int, int> ft_mp;
+		std::map<int, int> std_mp;
+		for (size_t i = 0; i < n; i++)
+		{
+			ft_mp.insert(ft::make_pair((int)i * 2, (int)i));
+			std_mp.insert(std::make_pair((int)i * 2, (int)i));
+		}
+		for (size_t i = 0; i < QUERIES; i++)
+			keys[i] = rand() % (n * 2 + 2);
+		long ft_sum = bench_bounds_on(ft_mp, "ft", n, keys);
+		long std_sum = bench_bounds_on(std_mp, "std", n, keys);
+		check("bounds", ft_sum, std_sum);
+	}
+	delete [] keys;
+}
+
+//Node pool
+
+typedef ft::map<int, int, std::less<int>, ft::pool_allocator<ft::pair<const int, int> > >					pool_map;
+typedef ft::map<int, int, std::less<int>, ft::pool_allocator<ft::pair<const int, int>, 2097152, true> >	huge_pool_map;
+
+int scramble(unsigned int i)
+{
+	return ((int)((i * 2654435761u) & 0x7fffffff));
+}
+
+template <typename MAP>
+long bench_churn_on(MAP &mp, std::string name)
+{
+	int *keys = new int[CHURN_SIZE];
+	unsigned int next = 0;
+	long sum = 0;
+	long int start;
+
+	srand(7);
+	start = ft_get_time();
+	for (size_t i = 0; i < CHURN_SIZE; i++)
+	{
+		keys[i] = scramble(next++);
+		mp.insert(typename MAP::value_type(keys[i], (int)i));
+	}
+	print_bench(name + " fill", CHURN_SIZE, start, ft_get_time(), CHURN_SIZE);
+	start = ft_get_time();
+	for (size_t i = 0; i < CHURN_ROUNDS; i++)
+	{
+		size_t idx = rand() % CHURN_SIZE;
+		mp.erase(keys[idx]);
+		keys[idx] = scramble(next++);
+		mp.insert(typename MAP::value_type(keys[idx], (int)i));
+	}
+	print_bench(name + " erase+insert", CHURN_SIZE, start, ft_get_time(), CHURN_ROUNDS);
+	start = ft_get_time();
+	for (typename MAP::iterator it = mp.begin(); it != mp.end(); it++)
+		sum += it->first + it->second;
+	print_bench(name + " scan", CHURN_SIZE, start, ft_get_time(), CHURN_SIZE);
+	delete [] keys;
+	return (sum);
+}
+
+void bench_pool()
+{
+	long std_sum;
+
+	{
+		std::map<int, int> mp;
+		std_sum = bench_churn_on(mp, "std");
+	}
+	{
+		ft::map<int, int> mp;
+		check("churn", bench_churn_on(mp, "ft"), std_sum);
+	}
+	{
+		pool_map mp;
+		check("churn", bench_churn_on(mp, "ft pool"), std_sum);
+		mp.clear();
+		std::cout << "ft pool trim released " << mp.trim() << " slabs" << std::endl;
+	}
+	{
+		huge_pool_map mp;
+		check("churn", bench_churn_on(mp, "ft pool huge pages"), std_sum);
+	}
+}
+
+//Hinted insert
+
+template <typename MAP>
+long bench_ingest_on(MAP &mp, std::string name, int *keys, bool hinted)
+{
+	long sum = 0;
+	long int start;
+	typename MAP::iterator hint = mp.end();
+
+	start = ft_get_time();
+	for (size_t i = 0; i < INGEST_SIZE; i++)
+	{
+		if (hinted)
+			hint = mp.insert(hint, typename MAP::value_type(keys[i], (int)i));
+		else
+			mp.insert(typename MAP::value_type(keys[i], (int)i));
+	}
+	print_bench(name, INGEST_SIZE, start, ft_get_time(), INGEST_SIZE);
+	for (typename MAP::iterator it = mp.begin(); it != mp.end(); it++)
+		sum += it->first + it->second;
+	return (sum);
+}
+
+void bench_ingest_keys(int *keys, std::string name)
+{
+	long std_sum;
+
+	{
+		std::map<int, int> mp;
+		std_sum = bench_ingest_on(mp, "std " + name, keys, false);
+	}
+	{
+		std::map<int, int> mp;
+		check("ingest", bench_ingest_on(mp, "std hinted " + name, keys, true), std_sum);
+	}
+	{
+		ft::map<int, int> mp;
+		check("ingest", bench_ingest_on(mp, "ft " + name, keys, false), std_sum);
+	}
+	{
+		ft::map<int, int> mp;
+		check("ingest", bench_ingest_on(mp, "ft hinted " + name, keys, true), std_sum);
+	}
+}
+
+void bench_ingest()
+{
+	int *keys = new int[INGEST_SIZE];
+
+	for (size_t i = 0; i < INGEST_SIZE; i++)
+		keys[i] = (int)i;
+	bench_ingest_keys(keys, "sorted");
+	for (size_t i = 0; i + 1 < INGEST_SIZE; i += 2)
+		if (rand() % 4 == 0)
+			std::swap(keys[i], keys[i + 1]);
+	bench_ingest_keys(keys, "nearly sorted");
+	delete [] keys;
+}
+
+//Sorted load
+
+template <typename MAP, typename PAIR>
+long bench_load_on(std::vector<PAIR> &pairs, std::string name)
+{
+	long sum = 0;
+	long int start;
+
+	start = ft_get_time();
+	MAP mp(pairs.begin(), pairs.end());
+	print_bench(name, LOAD_SIZE, start, ft_get_time(), LOAD_SIZE);
+	for (typename MAP::iterator it = mp.begin(); it != mp.end(); it++)
+		sum += it->first + it->second;
+	return (sum);
+}
+
+template <typename MAP>
+long bench_load_loop_on(std::string name)
+{
+	long sum = 0;
+	long int start;
+	MAP mp;
+
+	start = ft_get_time();
+	for (size_t i = 0; i < LOAD_SIZE; i++)
+		mp.insert(typename MAP::value_type((int)i, (int)i));
+	print_bench(name, LOAD_SIZE, start, ft_get_time(), LOAD_SIZE);
+	for (typename MAP::iterator it = mp.begin(); it != mp.end(); it++)
+		sum += it->first + it->second;
+	return (sum);
+}
+
+void bench_load()
+{
+	std::vector<std::pair<int, int> > std_pairs;
+	std::vector<ft::pair<int, int> > ft_pairs;
+
+	for (size_t i = 0; i < LOAD_SIZE; i++)
+	{
+		std_pairs.push_back(std::make_pair((int)i, (int)i));
+		ft_pairs.push_back(ft::make_pair((int)i, (int)i));
+	}
+	long std_sum = bench_load_on<std::map<int, int> >(std_pairs, "std range constructor");
+	check("load", bench_load_loop_on<std::map<int, int> >("std insert loop"), std_sum);
+	check("load", bench_load_on<ft::map<int, int> >(ft_pairs, "ft range constructor"), std_sum);
+	check("load", bench_load_loop_on<ft::map<int, int> >("ft insert loop"), std_sum);
+}
+
+//Copy
+
+template <typename MAP>
+long bench_copy_on(std::string name)
+{
+	MAP src;
+	MAP dst;
+	long sum = 0;
+	long int start;
+
+	for (size_t i = 0; i < COPY_SIZE; i++)
+		src.insert(typename MAP::value_type(scramble(i), (int)i));
+	for (size_t i = 0; i < COPY_SIZE / 2; i++)
+		dst.insert(typename MAP::value_type(scramble(i + COPY_SIZE), (int)i));
+	start = ft_get_time();
+	for (size_t i = 0; i < COPY_ROUNDS; i++)
+	{
+		MAP copy(src);
+		sum += copy.size();
+	}
+	print_bench(name + " copy constructor", COPY_SIZE, start, ft_get_time(), COPY_SIZE * COPY_ROUNDS);
+	start = ft_get_time();
+	for (size_t i = 0; i < COPY_ROUNDS; i++)
+	{
+		dst = src;
+		sum += dst.size();
+	}
+	print_bench(name + " operator=", COPY_SIZE, start, ft_get_time(), COPY_SIZE * COPY_ROUNDS);
+	for (typename MAP::iterator it = dst.begin(); it != dst.end(); it++)
+		sum += it->first + it->second;
+	return (sum);
+}
+
+void bench_copy()
+{
+	long std_sum = bench_copy_on<std::map<int, int> >("std");
+	check("copy", bench_copy_on<ft::map<int, int> >("ft"), std_sum);
+}
+
+//Teardown
+
+template <typename MAP>
+long bench_teardown_on(std::string name)
+{
+	long sum = 0;
+	long int start;
+	MAP *mp = new MAP;
+
+	for (size_t i = 0; i < TEARDOWN_SIZE; i++)
+		mp->insert(typename MAP::value_type(scramble(i), (int)i));
+	start = ft_get_time();
+	mp->erase(mp->lower_bound(1 << 29), mp->lower_bound(3 << 29));
+	print_bench(name + " erase half range", TEARDOWN_SIZE, start, ft_get_time(), 0);
+	start = ft_get_time();
+	for (int i = 0; i < 1000; i++)
+	{
+		typename MAP::iterator first = mp->lower_bound(scramble(i));
+		typename MAP::iterator last = first;
+		for (int j = 0; j < 10 && last != mp->end(); j++)
+			last++;
+		mp->erase(first, last);
+	}
+	print_bench(name + " erase 1000 small ranges", TEARDOWN_SIZE, start, ft_get_time(), 1000);
+	for (typename MAP::iterator it = mp->begin(); it != mp->end(); it++)
+		sum += it->first + it->second;
+	start = ft_get_time();
+	delete mp;
+	print_bench(name + " destructor", TEARDOWN_SIZE, start, ft_get_time(), 0);
+	return (sum);
+}
+
+void bench_teardown()
+{
+	long std_sum = bench_teardown_on<std::map<int, int> >("std");
+	check("teardown", bench_teardown_on<ft::map<int, int> >("ft"), std_sum);
+}
+
+//Insert path
+
+struct counting_less
+{
+	static long count;
+
+	bool operator()(const int &a, const int &b) const
+	{
+		count++;
+		return (a < b);
+	}
+};
+
+long counting_less::count = 0;
+
+template <typename MAP>
+long bench_insert_on(std::string name)
+{
+	MAP mp;
+	long sum = 0;
+	long int start;
+
+	counting_less::count = 0;
+	start = ft_get_time();
+	for (size_t i = 0; i < INSERT_SIZE; i++)
+		mp.insert(typename MAP::value_type(scramble(i) % INSERT_SIZE, (int)i));
+	print_bench(name + " insert", INSERT_SIZE, start, ft_get_time(), INSERT_SIZE);
+	std::cout << name << " insert: " << (float)counting_less::count / INSERT_SIZE << " comparisons/op" << std::endl;
+	counting_less::count = 0;
+	start = ft_get_time();
+	for (size_t i = 0; i < INSERT_SIZE; i++)
+		mp[scramble(i + INSERT_SIZE) % (INSERT_SIZE * 2)] += (int)i;
+	print_bench(name + " operator[]", INSERT_SIZE, start, ft_get_time(), INSERT_SIZE);
+	std::cout << name << " operator[]: " << (float)counting_less::count / INSERT_SIZE << " comparisons/op" << std::endl;
+	for (typename MAP::iterator it = mp.begin(); it != mp.end(); it++)
+		sum += it->first + it->second;
+	return (sum);
+}
+
+void bench_insert()
+{
+	long std_sum = bench_insert_on<std::map<int, int, counting_less> >("std");
+	check("insert", bench_insert_on<ft::map<int, int, counting_less> >("ft"), std_sum);
+}
+
+//Rebalancing work
+
+void print_stats(std::string name, const ft::tree_stats &stats, size_t ops)
+{
+	std::cout << "ft " << name << ": " << (float)stats.rotations / ops << " rotations/op, ";
+	std::cout << (float)stats.visited / ops << " visited/op" << std::endl;
+}
+
+void shuffle(int *keys, size_t n)
+{
+	for (size_t i = n - 1; i > 0; i--)
+		std::swap(keys[i], keys[rand() % (i + 1)]);
+}
+
+void bench_rebalance()
+{
+	ft::map<int, int> mp;
+	int *keys = new int[REBALANCE_SIZE];
+	long int start;
+
+	for (size_t i = 0; i < REBALANCE_SIZE; i++)
+		keys[i] = (int)i;
+	shuffle(keys, REBALANCE_SIZE);
+	start = ft_get_time();
+	for (size_t i = 0; i < REBALANCE_SIZE; i++)
+		mp.insert(ft::make_pair(keys[i], (int)i));
+	print_bench("ft random insert", REBALANCE_SIZE, start, ft_get_time(), REBALANCE_SIZE);
+	print_stats("random insert", mp.stats(), REBALANCE_SIZE);
+	std::cout << "ft height: " << mp.height() << std::endl;
+	shuffle(keys, REBALANCE_SIZE);
+	mp.reset_stats();
+	start = ft_get_time();
+	for (size_t i = 0; i < REBALANCE_SIZE; i++)
+		mp.erase(keys[i]);
+	print_bench("ft random erase", REBALANCE_SIZE, start, ft_get_time(), REBALANCE_SIZE);
+	print_stats("random erase", mp.stats(), REBALANCE_SIZE);
+	if (mp.size())
+		std::cout << "KO rebalance: " << mp.size() << " keys left" << std::endl;
+	mp.reset_stats();
+	start = ft_get_time();
+	for (size_t i = 0; i < REBALANCE_SIZE; i++)
+		mp.insert(mp.end(), ft::make_pair((int)i, (int)i));
+	print_bench("ft sorted insert", REBALANCE_SIZE, start, ft_get_time(), REBALANCE_SIZE);
+	print_stats("sorted insert", mp.stats(), REBALANCE_SIZE);
+	delete [] keys;
+}
+
+//Order statistics
+
+typedef ft::map<int, int, std::less<int>, std::allocator<ft::pair<const int, int> >, ft::order_statistic_policy>	ostat_map;
+
+void bench_order()
+{
+	ostat_map mp;
+	std::map<int, int> std_mp;
+	int *keys = new int[ORDER_SIZE];
+	long ft_sum = 0;
+	long std_sum = 0;
+	long int start;
+
+	for (size_t i = 0; i < ORDER_SIZE; i++)
+		keys[i] = (int)i * 2;
+	shuffle(keys, ORDER_SIZE);
+	{
+		ft::map<int, int> plain;
+		start = ft_get_time();
+		for (size_t i = 0; i < ORDER_SIZE; i++)
+			plain.insert(ft::make_pair(keys[i], (int)i));
+		print_bench("ft plain insert", ORDER_SIZE, start, ft_get_time(), ORDER_SIZE);
+	}
+	start = ft_get_time();
+	for (size_t i = 0; i < ORDER_SIZE; i++)
+		mp.insert(ft::make_pair(keys[i], (int)i));
+	print_bench("ft order statistic insert", ORDER_SIZE, start, ft_get_time(), ORDER_SIZE);
+	for (size_t i = 0; i < ORDER_SIZE; i++)
+		std_mp.insert(std::make_pair(keys[i], (int)i));
+	start = ft_get_time();
+	for (size_t i = 0; i < QUERIES; i++)
+		ft_sum += mp.nth(keys[i] / 2)->first;
+	print_bench("ft nth", ORDER_SIZE, start, ft_get_time(), QUERIES);
+	start = ft_get_time();
+	for (size_t i = 0; i < QUERIES; i++)
+		ft_sum += mp.rank(keys[i] + 1);
+	print_bench("ft rank", ORDER_SIZE, start, ft_get_time(), QUERIES);
+	start = ft_get_time();
+	for (size_t i = 0; i < QUERIES; i++)
+		ft_sum += mp.count_range(keys[i] / 2, keys[i]);
+	print_bench("ft count_range", ORDER_SIZE, start, ft_get_time(), QUERIES);
+	start = ft_get_time();
+	for (size_t i = 0; i < ORDER_STD_QUERIES; i++)
+	{
+		std::map<int, int>::iterator it = std_mp.begin();
+		std::advance(it, keys[i] / 2);
+		std_sum += it->first;
+	}
+	print_bench("std advance", ORDER_SIZE, start, ft_get_time(), ORDER_STD_QUERIES);
+	start = ft_get_time();
+	for (size_t i = 0; i < ORDER_STD_QUERIES; i++)
+		std_sum += std::distance(std_mp.begin(), std_mp.lower_bound(keys[i] + 1));
+	print_bench("std distance", ORDER_SIZE, start, ft_get_time(), ORDER_STD_QUERIES);
+	long ft_check = 0;
+	for (size_t i = 0; i < ORDER_STD_QUERIES; i++)
+		ft_check += mp.nth(keys[i] / 2)->first + mp.rank(keys[i] + 1);
+	check("order", ft_check, std_sum);
+	if (ft_sum == 42)
+		std::cout << std::endl;
+	delete [] keys;
+}
+
+//Compact nodes
+
+typedef ft::map<int, int, std::less<int>, ft::pool_allocator<ft::pair<const int, int> >, ft::compact_policy>	compact_map;
+
+template <typename MAP>
+long bench_layout_on(std::string name, int *keys)
+{
+	MAP mp;
+	long sum = 0;
+	long int start;
+
+	std::cout << name << " node: " << sizeof(typename MAP::map_node) << " bytes/entry" << std::endl;
+	start = ft_get_time();
+	for (size_t i = 0; i < LAYOUT_SIZE; i++)
+		mp.insert(typename MAP::value_type(keys[i], (int)i));
+	print_bench(name + " insert", LAYOUT_SIZE, start, ft_get_time(), LAYOUT_SIZE);
+	start = ft_get_time();
+	for (size_t i = 0; i < QUERIES; i++)
+		sum += mp.find(keys[(i * 7919) % LAYOUT_SIZE])->second;
+	print_bench(name + " find", LAYOUT_SIZE, start, ft_get_time(), QUERIES);
+	start = ft_get_time();
+	for (typename MAP::iterator it = mp.begin(); it != mp.end(); it++)
+		sum += it->first;
+	print_bench(name + " scan", LAYOUT_SIZE, start, ft_get_time(), LAYOUT_SIZE);
+	return (sum);
+}
+
+void bench_layout()
+{
+	int *keys = new int[LAYOUT_SIZE];
+
+	for (size_t i = 0; i < LAYOUT_SIZE; i++)
+		keys[i] = (int)i;
+	shuffle(keys, LAYOUT_SIZE);
+	long sum = bench_layout_on<pool_map>("ft pool", keys);
+	check("layout", bench_layout_on<compact_map>("ft pool compact", keys), sum);
+	delete [] keys;
+}
+
+//B+tree
+
+template <typename MAP>
+long bench_btree_on(std::string name, int *keys)
+{
+	MAP mp;
+	long sum = 0;
+	long int start;
+
+	start = ft_get_time();
+	for (size_t i = 0; i < BTREE_SIZE; i++)
+		mp.insert(typename MAP::value_type(keys[i], (int)i));
+	print_bench(name + " insert", BTREE_SIZE, start, ft_get_time(), BTREE_SIZE);
+	start = ft_get_time();
+	for (size_t i = 0; i < QUERIES; i++)
+		sum += mp.find(keys[(i * 7919) % BTREE_SIZE])->second;
+	print_bench(name + " find", BTREE_SIZE, start, ft_get_time(), QUERIES);
+	start = ft_get_time();
+	for (typename MAP::iterator it = mp.begin(); it != mp.end(); it++)
+		sum += it->first;
+	print_bench(name + " scan", BTREE_SIZE, start, ft_get_time(), BTREE_SIZE);
+	return (sum);
+}
+
+void bench_btree()
+{
+	int *keys = new int[BTREE_SIZE];
+
+	for (size_t i = 0; i < BTREE_SIZE; i++)
+		keys[i] = (int)i;
+	shuffle(keys, BTREE_SIZE);
+	long std_sum = bench_btree_on<std::map<int, int> >("std", keys);
+	check("map", bench_btree_on<ft::map<int, int> >("ft map", keys), std_sum);
+	check("btree_map", bench_btree_on<ft::btree_map<int, int> >("ft btree_map", keys), std_sum);
+	{
+		ft::btree_map<int, int> mp;
+		long int start = ft_get_time();
+		for (size_t i = 0; i < BTREE_SIZE; i++)
+			mp.insert(ft::make_pair((int)i, (int)i));
+		print_bench("ft btree_map sorted insert", BTREE_SIZE, start, ft_get_time(), BTREE_SIZE);
+	}
+	delete [] keys;
+}
+
+//Flat map
+
+typedef ft::flat_map<int, int, std::less<int>, std::allocator<ft::pair<int, int> >, true>	split_flat_map;
+
+template <typename MAP>
+long bench_flat_lookup(MAP &mp, std::string name, int *keys)
+{
+	long sum = 0;
+	long int start;
+
+	start = ft_get_time();
+	for (size_t i = 0; i < QUERIES; i++)
+		sum += mp.find(keys[(i * 7919) % FLAT_SIZE])->second;
+	print_bench(name + " find", FLAT_SIZE, start, ft_get_time(), QUERIES);
+	start = ft_get_time();
+	for (size_t i = 0; i < QUERIES; i++)
+		sum += mp.lower_bound(keys[(i * 7919) % FLAT_SIZE] - 1)->second;
+	print_bench(name + " lower_bound", FLAT_SIZE, start, ft_get_time(), QUERIES);
+	start = ft_get_time();
+	for (typename MAP::iterator it = mp.begin(); it != mp.end(); it++)
+		sum += (*it).first;
+	print_bench(name + " scan", FLAT_SIZE, start, ft_get_time(), FLAT_SIZE);
+	return (sum);
+}
+
+template <typename FLAT>
+long bench_flat_on(std::string name, ft::vector<ft::pair<int, int> > &input, int *keys)
+{
+	FLAT mp;
+	long int start;
+
+	start = ft_get_time();
+	mp.insert(input.begin(), input.end());
+	print_bench(name + " bulk insert", FLAT_SIZE, start, ft_get_time(), FLAT_SIZE);
+	return (bench_flat_lookup(mp, name, keys));
+}
+
+void bench_flat()
+{
+	int *keys = new int[FLAT_SIZE];
+	ft::vector<ft::pair<int, int> > input;
+	long std_sum;
+	long int start;
+
+	for (size_t i = 0; i < FLAT_SIZE; i++)
+		keys[i] = (int)i * 2;
+	shuffle(keys, FLAT_SIZE);
+	for (size_t i = 0; i < FLAT_SIZE; i++)
+		input.push_back(ft::make_pair(keys[i], (int)i));
+	{
+		std::map<int, int> mp;
+		start = ft_get_time();
+		for (size_t i = 0; i < FLAT_SIZE; i++)
+			mp.insert(std::make_pair(keys[i], (int)i));
+		print_bench("std insert", FLAT_SIZE, start, ft_get_time(), FLAT_SIZE);
+		std_sum = bench_flat_lookup(mp, "std", keys);
+	}
+	{
+		ft::map<int, int> mp;
+		start = ft_get_time();
+		mp.insert(input.begin(), input.end());
+		print_bench("ft map insert", FLAT_SIZE, start, ft_get_time(), FLAT_SIZE);
+		check("map", bench_flat_lookup(mp, "ft map", keys), std_sum);
+	}
+	check("flat_map", bench_flat_on<ft::flat_map<int, int> >("ft flat_map", input, keys), std_sum);
+	check("split flat_map", bench_flat_on<split_flat_map>("ft split flat_map", input, keys), std_sum);
+	{
+		ft::flat_map<int, int> mp;
+		start = ft_get_time();
+		for (size_t i = 0; i < FLAT_SIZE / 100; i++)
+			mp.insert(input[i]);
+		print_bench("ft flat_map insert one by one", FLAT_SIZE / 100, start, ft_get_time(), FLAT_SIZE / 100);
+	}
+	std::cout << "bytes/entry: std::map and ft::map nodes 40, flat_map "
+		<< sizeof(ft::pair<int, int>) << ", split " << sizeof(int) + sizeof(int) << std::endl;
+	delete [] keys;
+}
+
+//Split and join
+
+template <typename MAP>
+long bench_split_on(std::string name, int cut_range)
+{
+	MAP mp;
+	long sum = 0;
+	long int start;
+
+	for (size_t i = 0; i < SPLIT_SIZE; i++)
+		mp.insert(ft::make_pair((int)i, (int)i));
+	start = ft_get_time();
+	for (size_t i = 0; i < SPLIT_ROUNDS; i++)
+	{
+		MAP upper = mp.split(rand() % cut_range);
+		sum += mp.size();
+		mp.join(upper);
+	}
+	print_bench(name + " split+join", SPLIT_SIZE, start, ft_get_time(), SPLIT_ROUNDS);
+	return (sum);
+}
+
+void bench_split()
+{
+	std::map<int, int> mp;
+	long std_sum = 0;
+	long int start;
+
+	for (size_t i = 0; i < SPLIT_SIZE; i++)
+		mp.insert(std::make_pair((int)i, (int)i));
+	start = ft_get_time();
+	for (size_t i = 0; i < SPLIT_STD_ROUNDS; i++)
+	{
+		std::map<int, int>::iterator cut = mp.lower_bound(rand() % SPLIT_SIZE);
+		std::map<int, int> upper(cut, mp.end());
+		mp.erase(cut, mp.end());
+		std_sum += mp.size();
+		mp.insert(upper.begin(), upper.end());
+	}
+	print_bench("std split+join by elements", SPLIT_SIZE, start, ft_get_time(), SPLIT_STD_ROUNDS);
+	if (std_sum == 42)
+		std::cout << std::endl;
+	bench_split_on<ft::map<int, int> >("ft", SPLIT_SIZE);
+	bench_split_on<ft::map<int, int> >("ft cut in first 1%", SPLIT_SIZE / 100);
+	bench_split_on<ostat_map>("ft order statistic", SPLIT_SIZE);
+}
+
+//Set algebra
+
+void bench_setop_skewed()
+{
+	ft::map<int, int> big;
+	std::map<int, int> std_big;
+	ft::map<int, int> small;
+	std::map<int, int> std_small;
+	long ft_sum = 0;
+	long std_sum = 0;
+	long int start;
+
+	for (int i = 0; i < SETOP_BIG; i++)
+	{
+		big.insert(big.end(), ft::make_pair(i * 2, i));
+		std_big.insert(std_big.end(), std::make_pair(i * 2, i));
+	}
+	for (int i = 0; i < SETOP_SMALL; i++)
+	{
+		int k = scramble(i) % SETOP_BIG * 2 + i % 2;
+		small[k] = i;
+		std_small[k] = i;
+	}
+	start = ft_get_time();
+	for (size_t r = 0; r < SETOP_ROUNDS; r++)
+	{
+		for (std::map<int, int>::iterator it = std_small.begin(); it != std_small.end(); ++it)
+			std_big.insert(*it);
+		std_sum += std_big.size();
+		for (std::map<int, int>::iterator it = std_small.begin(); it != std_small.end(); ++it)
+			if (it->first % 2)
+				std_big.erase(it->first);
+	}
+	print_bench("std insert+erase loop 1k into 10M", SETOP_BIG, start, ft_get_time(), SETOP_ROUNDS);
+	ft::map<int, int> odd;
+	for (ft::map<int, int>::iterator it = small.begin(); it != small.end(); ++it)
+		if (it->first % 2)
+			odd.insert(*it);
+	start = ft_get_time();
+	for (size_t r = 0; r < SETOP_ROUNDS; r++)
+	{
+		big.merge_union(small);
+		ft_sum += big.size();
+		big.subtract(odd);
+	}
+	print_bench("ft merge_union+subtract 1k into 10M", SETOP_BIG, start, ft_get_time(), SETOP_ROUNDS);
+	check("union", ft_sum, std_sum);
+	ft_sum = 0;
+	std_sum = 0;
+	start = ft_get_time();
+	for (size_t r = 0; r < SETOP_ROUNDS; r++)
+	{
+		std::map<int, int> inter;
+		for (std::map<int, int>::iterator it = std_small.begin(); it != std_small.end(); ++it)
+			if (std_big.count(it->first))
+				inter.insert(inter.end(), *it);
+		std_sum += inter.size();
+	}
+	print_bench("std find loop 1k intersect 10M", SETOP_BIG, start, ft_get_time(), SETOP_ROUNDS);
+	start = ft_get_time();
+	for (size_t r = 0; r < SETOP_ROUNDS; r++)
+	{
+		ft::map<int, int> inter(small);
+		inter.intersect(big);
+		ft_sum += inter.size();
+	}
+	print_bench("ft intersect 1k with 10M", SETOP_BIG, start, ft_get_time(), SETOP_ROUNDS);
+	check("intersect", ft_sum, std_sum);
+}
+
+void bench_setop_even()
+{
+	ft::map<int, int> a;
+	ft::map<int, int> b;
+	std::map<int, int> std_a;
+	std::map<int, int> std_b;
+	long int start;
+
+	for (int i = 0; i < SETOP_EVEN; i++)
+	{
+		a[scramble(i)] = i;
+		b[scramble(i + SETOP_EVEN / 2)] = i;
+		std_a[scramble(i)] = i;
+		std_b[scramble(i + SETOP_EVEN / 2)] = i;
+	}
+	start = ft_get_time();
+	for (std::map<int, int>::iterator it = std_b.begin(); it != std_b.end(); ++it)
+		std_a.insert(*it);
+	print_bench("std insert loop 1M into 1M", SETOP_EVEN, start, ft_get_time(), 1);
+	start = ft_get_time();
+	a.merge_union(b);
+	print_bench("ft merge_union 1M into 1M", SETOP_EVEN, start, ft_get_time(), 1);
+	check("union", a.size(), std_a.size());
+}
+
+void bench_setop()
+{
+	bench_setop_skewed();
+	bench_setop_even();
+}
+
+struct s_bench
+{
+	std::string	name;
+	void		(*fct)(void);
+};
+
+int main(int ac, char **av)
+{
+	s_bench benchs[] = {
+		{"bounds", bench_bounds},
+		{"pool", bench_pool},
+		{"ingest", bench_ingest},
+		{"load", bench_load},
+		{"copy", bench_copy},
+		{"teardown", bench_teardown},
+		{"insert", bench_insert},
+		{"rebalance", bench_rebalance},
+		{"order", bench_order},
+		{"layout", bench_layout},
+		{"btree", bench_btree},
+		{"flat", bench_flat},
+		{"split", bench_split},
+		{"setop", bench_setop},
+	};
+
+	srand(42);
+	for (size_t i = 0; i < sizeof(benchs) / sizeof(*benchs); i++)
+	{
+		if (ac > 1 && benchs[i].name != av[1])
+			continue ;
+		std::cout << "------" << benchs[i].name << "------" << std::endl;
+		benchs[i].fct();
+	}
+	return (0);
+}